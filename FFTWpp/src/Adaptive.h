@@ -0,0 +1,251 @@
+#ifndef FFTWPP_ADAPTIVE_GUARD_H
+#define FFTWPP_ADAPTIVE_GUARD_H
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <ranges>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Core.h"
+#include "NumericConcepts/Numeric.hpp"
+#include "NumericConcepts/Ranges.hpp"
+#include "Options.h"
+#include "Pipeline.h"
+#include "Plan.h"
+#include "Timing.h"
+#include "Utility.h"
+#include "Views.h"
+#include "Wisdom.h"
+
+namespace FFTWpp {
+
+// Settings of an AdaptivePlan.
+struct AdaptiveOptions {
+  double expectedTime = 0;   // Expected seconds per execute, or zero to take
+                             // the median of the first window.
+  int window = 64;           // Executes in each window of latencies.
+  double degradation = 1.5;  // Ratio of a window's median latency to the
+                             // expected time at which it is degraded.
+  int patience = 3;          // Consecutive degraded windows before
+                             // re-planning.
+  double improvement = 1.1;  // Speedup needed for a new plan to be used.
+  Flag flag = Measure;       // Flag for re-planning.
+};
+
+namespace Ranges {
+
+// A long-lived plan that re-plans itself when its executes slow down, as
+// when a process moves between hosts or the load of other processes
+// changes. Execute latencies are gathered in windows, and when the median
+// of several consecutive windows exceeds the expected time by the given
+// ratio, a new plan is made on a background thread on scratch arrays,
+// without the wisdom held for the precision.
+// Both plans are timed there, and the new one replaces the current plan
+// only if it is faster by the given margin. After each re-plan the expected
+// time is taken afresh from the next window, so that a host which is simply
+// slower does not cause repeated re-planning. Execute must be called from
+// one thread at a time, and executes continue with the current plan while
+// re-planning.
+template <NumericConcepts::RealOrComplexWritableRange InView,
+          NumericConcepts::RealOrComplexWritableRange OutView>
+requires NumericConcepts::SameRangePrecision<InView, OutView>
+class AdaptivePlan {
+  using InType = std::ranges::range_value_t<InView>;
+  using OutType = std::ranges::range_value_t<OutView>;
+  using Real = NumericConcepts::RemoveComplex<InType>;
+  using ScratchPlan = Plan<std::span<InType>, std::span<OutType>>;
+
+ public:
+  // Minimum time in seconds spent timing each plan when re-planning.
+  static constexpr double TimingSeconds = 0.02;
+
+  // Constructor given the views, the flag for the initial plan, the
+  // options, and any direction or kinds.
+  template <typename... Args>
+  AdaptivePlan(View<InView> in, View<OutView> out, Flag flag,
+               AdaptiveOptions options, Args... args)
+      : _in{in},
+        _out{out},
+        _options{options},
+        _expected{options.expectedTime},
+        _scratchIn(ScratchSize(in, out), Allocator<InType>("AdaptivePlan")),
+        _scratchOut(InPlace(in, out) ? 0 : StorageSize(out),
+                    Allocator<OutType>("AdaptivePlan")) {
+    assert(_options.window > 0 && _options.patience > 0);
+    auto inView = View(std::span(_scratchIn.data(), StorageSize(_in)),
+                       static_cast<const Layout&>(_in));
+    if (_in.DataOwnership() == Ownership::Consumable) {
+      inView = inView.Consumable();
+    }
+    if (_in.DataOwnership() == Ownership::Preserved) {
+      inView = inView.Preserved();
+    }
+    auto outData = InPlace(in, out)
+                       ? reinterpret_cast<OutType*>(_scratchIn.data())
+                       : _scratchOut.data();
+    auto outView = View(std::span(outData, StorageSize(_out)),
+                        static_cast<const Layout&>(_out));
+    // The user's arrays need not share the alignment of the scratch arrays,
+    // so the plan for unaligned arrays is made with each plan rather than
+    // on first use within Execute.
+    _make = [inView, outView, args...](Flag flag) {
+      auto plan =
+          std::make_shared<ScratchPlan>(inView, outView, flag, args...);
+      plan->PrepareUnaligned();
+      return plan;
+    };
+    _plan.store(_make(flag));
+  }
+
+  AdaptivePlan(const AdaptivePlan&) = delete;
+  AdaptivePlan& operator=(const AdaptivePlan&) = delete;
+
+  ~AdaptivePlan() { Wait(); }
+
+  // Execute the plan, recording its latency.
+  void Execute() {
+    auto plan = _plan.load();
+    auto start = std::chrono::steady_clock::now();
+    plan->Execute(std::span(_in.DataPointer(), StorageSize(_in)),
+                  std::span(_out.DataPointer(), StorageSize(_out)));
+    Record(Seconds(start));
+  }
+
+  // Normalisation factor for inverse transformations.
+  auto Normalisation() const { return _plan.load()->Normalisation(); }
+
+  // Wait for any re-planning to finish.
+  void Wait() {
+    if (_worker.joinable()) _worker.join();
+  }
+
+  // Returns true while re-planning.
+  bool Replanning() const { return _replanning.load(); }
+
+  // Return the number of re-plans made, and the number of those in which
+  // the new plan was used.
+  auto Replans() const { return _replans.load(); }
+  auto Swaps() const { return _swaps.load(); }
+
+  // Return the expected time per execute, which is zero until set by the
+  // first window, and the median latency of the last window.
+  auto ExpectedTime() const { return _expected; }
+  auto LastLatency() const { return _last; }
+
+ private:
+  View<InView> _in;
+  View<OutView> _out;
+  AdaptiveOptions _options;
+  double _expected;
+  double _last = 0;
+  int _degraded = 0;
+  std::vector<double> _latencies;
+
+  // Scratch arrays used in planning and timing.
+  vector<InType> _scratchIn;
+  vector<OutType> _scratchOut;
+  std::function<std::shared_ptr<ScratchPlan>(Flag)> _make;
+  std::atomic<std::shared_ptr<ScratchPlan>> _plan;
+
+  // Plans replaced by re-planning, which are destroyed on the worker once
+  // no execute holds them, as destroying a plan waits on the planner.
+  std::vector<std::shared_ptr<ScratchPlan>> _retired;
+
+  std::thread _worker;
+  std::atomic<bool> _replanning = false;
+  std::atomic<bool> _rebase = false;
+  std::atomic<long> _replans = 0;
+  std::atomic<long> _swaps = 0;
+
+  // Return the size of the scratch input, which for in-place transforms
+  // also holds the output.
+  static std::size_t ScratchSize(View<InView>& in, View<OutView>& out) {
+    if (!InPlace(in, out)) return StorageSize(in);
+    auto outBytes = StorageSize(out) * sizeof(OutType);
+    return std::max(StorageSize(in),
+                    (outBytes + sizeof(InType) - 1) / sizeof(InType));
+  }
+
+  static bool InPlace(View<InView>& in, View<OutView>& out) {
+    return static_cast<void*>(in.DataPointer()) ==
+           static_cast<void*>(out.DataPointer());
+  }
+
+  // Add a latency to the current window, and re-plan once enough windows
+  // are degraded.
+  void Record(double latency) {
+    if (_rebase.exchange(false)) {
+      _expected = 0;
+      _degraded = 0;
+      _latencies.clear();
+    }
+    _latencies.push_back(latency);
+    if (static_cast<int>(_latencies.size()) < _options.window) return;
+    auto middle = _latencies.begin() + _latencies.size() / 2;
+    std::ranges::nth_element(_latencies, middle);
+    _last = *middle;
+    _latencies.clear();
+    if (_expected == 0) {
+      _expected = _last;
+      return;
+    }
+    _degraded = _last > _options.degradation * _expected ? _degraded + 1 : 0;
+    if (_degraded >= _options.patience && !_replanning.load()) {
+      _degraded = 0;
+      Wait();
+      _replanning = true;
+      _worker = std::thread([this]() { Replan(); });
+    }
+  }
+
+  // Make a new plan on the scratch arrays and time it against the current
+  // plan there, swapping it in if it is sufficiently faster. The wisdom of
+  // the precision, which may have been gathered on another host, would
+  // give back the current algorithm, so the candidate is planned with that
+  // wisdom forgotten. The old wisdom is then restored, and the candidate's
+  // wisdom is added over it only if the candidate is used.
+  void Replan() {
+    std::erase_if(_retired, [](const auto& plan) {
+      return plan.use_count() == 1;
+    });
+    auto current = _plan.load();
+    auto candidate = std::shared_ptr<ScratchPlan>();
+    auto fresh = std::string();
+    {
+      auto lock = std::scoped_lock(PlannerMutex());
+      auto wisdom = ExportWisdomString<Real>();
+      ForgetWisdom<Real>();
+      candidate = _make(_options.flag);
+      fresh = ExportWisdomString<Real>();
+      ForgetWisdom<Real>();
+      ImportWisdomString<Real>(wisdom);
+    }
+    RandomiseValues(_scratchIn);
+    auto currentTime = ExecuteTime(*current, TimingSeconds);
+    RandomiseValues(_scratchIn);
+    auto candidateTime = ExecuteTime(*candidate, TimingSeconds);
+    if (candidateTime * _options.improvement < currentTime) {
+      ImportWisdomString<Real>(fresh);
+      _plan.store(candidate);
+      _retired.push_back(std::move(current));
+      _swaps++;
+    }
+    _replans++;
+    _rebase = true;
+    _replanning = false;
+  }
+};
+
+}  // namespace Ranges
+
+}  // namespace FFTWpp
+
+#endif  // FFTWPP_ADAPTIVE_GUARD_H
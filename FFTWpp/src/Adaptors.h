@@ -0,0 +1,243 @@
+#ifndef FFTWPP_ADAPTORS_GUARD_H
+#define FFTWPP_ADAPTORS_GUARD_H
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <complex>
+#include <iterator>
+#include <memory>
+#include <numbers>
+#include <optional>
+#include <ranges>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "Core.h"
+#include "NumericConcepts/Numeric.hpp"
+#include "Options.h"
+#include "Plan.h"
+#include "Views.h"
+#include "fftw3.h"
+
+namespace FFTWpp {
+
+// Returns a periodic Hann window of the given length.
+template <NumericConcepts::Real Real = double>
+auto Hann(int n) {
+  auto window = vector<Real>(n);
+  for (auto i = 0; i < n; i++) {
+    window[i] = std::pow(std::sin(std::numbers::pi_v<Real> * i / n), 2);
+  }
+  return window;
+}
+
+namespace Ranges {
+
+// View of the real-to-complex transforms of a range of equally sized real
+// frames. Frames are copied in aligned chunks into a buffer on which a
+// batched plan is executed, and only when iteration reaches the chunk. The
+// elements are spans into the chunk's output buffer, and so remain valid
+// until the iterator moves past the chunk. The view is an input range and
+// may be used with unbounded inputs.
+template <std::ranges::input_range V>
+requires std::ranges::view<V> and
+         std::ranges::input_range<std::ranges::range_reference_t<V>> and
+         NumericConcepts::Real<std::ranges::range_value_t<
+             std::ranges::range_reference_t<V>>>
+class RealTransformView
+    : public std::ranges::view_interface<RealTransformView<V>> {
+  using Real =
+      std::ranges::range_value_t<std::ranges::range_reference_t<V>>;
+  using Complex = std::complex<Real>;
+
+  // Buffers, plan and position in the underlying range.
+  class State {
+   public:
+    State(std::ranges::iterator_t<V> it, std::ranges::sentinel_t<V> end,
+          int chunk, Flag flag)
+        : _it{std::move(it)}, _end{std::move(end)}, _chunk{chunk} {
+      if (_it == _end) return;
+      // The first frame gives the size, and is read once so that frames
+      // computed on each dereference are not computed twice.
+      auto first = std::vector<Real>();
+      std::ranges::copy(*_it, std::back_inserter(first));
+      ++_it;
+      _n = static_cast<int>(first.size());
+      _in = vector<Real>(_chunk * _n);
+      _out = vector<Complex>(_chunk * (_n / 2 + 1));
+      auto inN = std::vector{_n};
+      auto outN = std::vector{_n / 2 + 1};
+      auto inLayout = Layout(1, inN, _chunk, inN, 1, _n);
+      auto outLayout = Layout(1, outN, _chunk, outN, 1, outN.front());
+      _plan.emplace(View(_in, inLayout), View(_out, outLayout), flag);
+      std::ranges::copy(first, _in.begin());
+      Fill(1);
+    }
+
+    // Read the next chunk of frames, after the given number already read,
+    // and transform it.
+    void Fill(int count = 0) {
+      _count = count;
+      for (; _count < _chunk && _it != _end; ++_it, ++_count) {
+        auto&& frame = *_it;
+        assert(std::ranges::distance(frame) == _n);
+        std::ranges::copy(frame, _in.begin() + _count * _n);
+      }
+      if (_count > 0) _plan->Execute();
+    }
+
+    // Return the number of transforms in the current chunk.
+    auto Count() const { return _count; }
+
+    // Return the ith transform within the current chunk.
+    auto Spectrum(int i) const {
+      auto size = _n / 2 + 1;
+      return std::span<const Complex>(_out.data() + i * size, size);
+    }
+
+   private:
+    std::ranges::iterator_t<V> _it;
+    std::ranges::sentinel_t<V> _end;
+    int _chunk;
+    int _n = 0;
+    int _count = 0;
+    vector<Real> _in;
+    vector<Complex> _out;
+    std::optional<Plan<std::ranges::ref_view<vector<Real>>,
+                       std::ranges::ref_view<vector<Complex>>>>
+        _plan;
+  };
+
+  class Iterator {
+   public:
+    using value_type = std::span<const Complex>;
+    using difference_type = std::ptrdiff_t;
+    using iterator_concept = std::input_iterator_tag;
+
+    Iterator() = default;
+    Iterator(State* state) : _state{state} {}
+
+    auto operator*() const { return _state->Spectrum(_index); }
+
+    auto& operator++() {
+      if (++_index == _state->Count()) {
+        _state->Fill();
+        _index = 0;
+      }
+      return *this;
+    }
+
+    void operator++(int) { ++*this; }
+
+    friend bool operator==(const Iterator& it, std::default_sentinel_t) {
+      return it._state->Count() == 0;
+    }
+
+   private:
+    State* _state = nullptr;
+    int _index = 0;
+  };
+
+ public:
+  RealTransformView(V base, int chunk, Flag flag)
+      : _base{std::move(base)}, _chunk{chunk}, _flag{flag} {
+    assert(_chunk > 0);
+  }
+
+  auto begin() {
+    _state = std::make_shared<State>(std::ranges::begin(_base),
+                                     std::ranges::end(_base), _chunk, _flag);
+    return Iterator(_state.get());
+  }
+
+  auto end() { return std::default_sentinel; }
+
+ private:
+  V _base;
+  int _chunk;
+  Flag _flag;
+  std::shared_ptr<State> _state;
+};
+
+}  // namespace Ranges
+
+namespace views {
+
+// Default number of frames transformed together by views::rfft.
+constexpr int DefaultChunk = 64;
+
+// Range adaptor closure applying a function to the range on its left.
+template <typename F>
+class Closure {
+ public:
+  constexpr Closure(F f) : _f{std::move(f)} {}
+
+  template <std::ranges::viewable_range R>
+  friend auto operator|(R&& r, const Closure& closure) {
+    return closure._f(std::forward<R>(r));
+  }
+
+ private:
+  F _f;
+};
+
+// Multiplies each frame elementwise by the given window.
+template <std::ranges::input_range W>
+requires NumericConcepts::Real<std::ranges::range_value_t<W>>
+auto window(W&& w) {
+  using Real = std::ranges::range_value_t<W>;
+  auto values = std::make_shared<const std::vector<Real>>(std::ranges::begin(w),
+                                                          std::ranges::end(w));
+  return Closure([values]<std::ranges::viewable_range R>(R&& frames) {
+    return std::forward<R>(frames) |
+           std::views::transform([values]<typename Frame>(Frame&& frame) {
+             return std::views::zip_transform(
+                 std::multiplies<>(),
+                 std::views::all(std::forward<Frame>(frame)),
+                 std::views::all(*values));
+           });
+  });
+}
+
+// Real-to-complex transform of each frame, computed lazily in chunks.
+class RealTransformAdaptor {
+ public:
+  // Set the number of frames per chunk and the planning flag.
+  auto operator()(int chunk, Flag flag = Measure) const {
+    return Closure([chunk, flag]<std::ranges::viewable_range R>(R&& frames) {
+      return Ranges::RealTransformView(std::views::all(std::forward<R>(frames)),
+                                       chunk, flag);
+    });
+  }
+
+  template <std::ranges::viewable_range R>
+  friend auto operator|(R&& frames, const RealTransformAdaptor&) {
+    return Ranges::RealTransformView(std::views::all(std::forward<R>(frames)),
+                                     DefaultChunk, Measure);
+  }
+};
+
+inline constexpr auto rfft = RealTransformAdaptor{};
+
+// Squared magnitude of each value within each spectrum.
+class PowerAdaptor {
+ public:
+  template <std::ranges::viewable_range R>
+  friend auto operator|(R&& spectra, const PowerAdaptor&) {
+    return std::forward<R>(spectra) |
+           std::views::transform([]<typename Spectrum>(Spectrum&& spectrum) {
+             return std::views::all(std::forward<Spectrum>(spectrum)) |
+                    std::views::transform([](auto z) { return std::norm(z); });
+           });
+  }
+};
+
+inline constexpr auto power = PowerAdaptor{};
+
+}  // namespace views
+
+}  // namespace FFTWpp
+
+#endif  // FFTWPP_ADAPTORS_GUARD_H
@@ -0,0 +1,256 @@
+#ifndef FFTWPP_ADVISOR_GUARD_H
+#define FFTWPP_ADVISOR_GUARD_H
+
+#include <algorithm>
+#include <cassert>
+#include <complex>
+#include <cstddef>
+#include <limits>
+#include <ranges>
+#include <utility>
+#include <vector>
+
+#include "Core.h"
+#include "NumericConcepts/Numeric.hpp"
+#include "NumericConcepts/Ranges.hpp"
+#include "Options.h"
+#include "Plan.h"
+#include "Timing.h"
+#include "Tuner.h"
+#include "Utility.h"
+#include "Views.h"
+#include "fftw3.h"
+
+namespace FFTWpp {
+
+// Minimum time in seconds spent timing each arrangement.
+constexpr double AdviceSeconds = 0.02;
+
+// Ways of arranging a batch of transforms in memory.
+enum class Arrangement {
+  Contiguous,   // Each transform stored in turn, with stride=1.
+  Interleaved,  // Elements of the transforms interleaved, with dist=1.
+  Padded        // Contiguous, with padded embed dimensions.
+};
+
+namespace Ranges {
+
+// Returns the layout of a batch of transforms with the given dimensions in
+// the given arrangement. For the padded arrangement, the embed dimensions
+// other than the first are extended by the given number of elements, or for
+// one-dimensional transforms the distance between transforms is.
+inline Layout Arrange(Arrangement arrangement, std::vector<int> n, int howMany,
+                      int pad = 0) {
+  auto rank = static_cast<int>(n.size());
+  auto embed = n;
+  if (arrangement == Arrangement::Padded) {
+    embed = rank > 1 ? PaddedEmbed(Pad{pad}, n) : std::vector{n[0] + pad};
+  }
+  auto size =
+      std::ranges::fold_left_first(embed, std::multiplies<>()).value();
+  if (arrangement == Arrangement::Interleaved) {
+    return Layout(rank, n, howMany, embed, howMany, 1);
+  }
+  return Layout(rank, n, howMany, embed, 1, size);
+}
+
+// Returns the input and output layouts of a batch of transforms between
+// the given types with the given logical dimensions. For R2C and C2R
+// transforms the last dimension of the complex array is halved. Padded
+// arrangements are padded by a cache line.
+template <NumericConcepts::RealOrComplex InType,
+          NumericConcepts::RealOrComplex OutType>
+std::pair<Layout, Layout> Arrange(Arrangement arrangement, std::vector<int> n,
+                                  int howMany) {
+  auto complexN = n;
+  if constexpr (!std::same_as<InType, OutType>) {
+    complexN.back() = complexN.back() / 2 + 1;
+  }
+  auto inN = NumericConcepts::Real<InType> ? n : complexN;
+  auto outN = NumericConcepts::Real<OutType> ? n : complexN;
+  auto inPad = Pad::CacheLine<InType>().elements;
+  auto outPad = Pad::CacheLine<OutType>().elements;
+  return {Arrange(arrangement, inN, howMany, inPad),
+          Arrange(arrangement, outN, howMany, outPad)};
+}
+
+// Number of transforms copied together by Reorder.
+constexpr int ReorderBlock = 16;
+
+// Copies a batch of transforms between two layouts with the same rank,
+// dimensions and number of transforms. The batch is processed in blocks of
+// transforms so that, when converting to or from an interleaved layout,
+// each pass touches only a few cache lines on the strided side.
+template <NumericConcepts::RealOrComplex T>
+void Reorder(const Layout& from, const T* src, const Layout& to, T* dst) {
+  assert(from.Rank() == to.Rank());
+  assert(std::ranges::equal(from.N(), to.N()));
+  assert(from.HowMany() == to.HowMany());
+  auto rank = from.Rank();
+  auto n = std::vector<int>(std::ranges::begin(from.N()),
+                            std::ranges::end(from.N()));
+  auto inner = n.back();
+  auto rows = std::ranges::fold_left_first(n | std::views::take(rank - 1),
+                                           std::multiplies<>())
+                  .value_or(1);
+
+  // Offset of the start of the given row within a transform.
+  auto rowOffset = [&](const Layout& layout, int row) {
+    auto embed = layout.Embed();
+    auto offset = std::ptrdiff_t{0};
+    auto scale = static_cast<std::ptrdiff_t>(embed[rank - 1]);
+    for (auto d = rank - 2; d >= 0; d--) {
+      offset += (row % n[d]) * scale;
+      row /= n[d];
+      scale *= embed[d];
+    }
+    return offset * layout.Stride();
+  };
+
+  auto fromStride = static_cast<std::ptrdiff_t>(from.Stride());
+  auto fromDist = static_cast<std::ptrdiff_t>(from.Dist());
+  auto toStride = static_cast<std::ptrdiff_t>(to.Stride());
+  auto toDist = static_cast<std::ptrdiff_t>(to.Dist());
+  for (auto b0 = 0; b0 < from.HowMany(); b0 += ReorderBlock) {
+    auto b1 = std::min(b0 + ReorderBlock, from.HowMany());
+    for (auto row = 0; row < rows; row++) {
+      auto s = src + rowOffset(from, row);
+      auto d = dst + rowOffset(to, row);
+      for (auto j = 0; j < inner; j++) {
+        for (auto b = b0; b < b1; b++) {
+          d[b * toDist + j * toStride] = s[b * fromDist + j * fromStride];
+        }
+      }
+    }
+  }
+}
+
+// Copies the data in one view into another with a different layout.
+template <NumericConcepts::RealOrComplexWritableView FromView,
+          NumericConcepts::RealOrComplexWritableView ToView>
+requires NumericConcepts::SameRangeValueType<FromView, ToView>
+void Reorder(View<FromView> from, View<ToView> to) {
+  Reorder(static_cast<const Layout&>(from), from.DataPointer(),
+          static_cast<const Layout&>(to), to.DataPointer());
+}
+
+}  // namespace Ranges
+
+// The layouts found by AdviseLayout, along with the time per execute for
+// the chosen arrangement and for the contiguous arrangement.
+struct LayoutAdvice {
+  Arrangement arrangement = Arrangement::Contiguous;
+  Ranges::Layout in;
+  Ranges::Layout out;
+  double time = 0;
+  double contiguousTime = 0;
+
+  // Speedup of the chosen arrangement relative to the contiguous one.
+  auto Speedup() const { return contiguousTime / time; }
+};
+
+// Benchmarks the arrangements of a batch of transforms with the given
+// logical dimensions, and returns the fastest. Padded arrangements extend
+// the embed dimensions by a cache line, which avoids cache-set aliasing
+// when dimensions are powers of two. Data can be converted into the chosen
+// layouts using Reorder. The remaining arguments are the direction or kinds
+// as needed.
+template <NumericConcepts::RealOrComplex InType,
+          NumericConcepts::RealOrComplex OutType, typename... Args>
+requires NumericConcepts::SamePrecision<InType, OutType>
+LayoutAdvice AdviseLayout(std::vector<int> n, int howMany, Flag flag,
+                          Args... args) {
+  assert(!n.empty() && howMany > 0);
+  auto advice = LayoutAdvice{};
+  advice.time = std::numeric_limits<double>::infinity();
+  for (auto arrangement : {Arrangement::Contiguous, Arrangement::Interleaved,
+                           Arrangement::Padded}) {
+    if (arrangement == Arrangement::Interleaved && howMany == 1) continue;
+    auto [inLayout, outLayout] =
+        Ranges::Arrange<InType, OutType>(arrangement, n, howMany);
+    auto in = vector<InType>(inLayout.size());
+    auto out = vector<OutType>(outLayout.size());
+    auto plan = Ranges::Plan(Ranges::View(in, inLayout),
+                             Ranges::View(out, outLayout), flag, args...);
+    RandomiseValues(in);
+    auto time = ExecuteTime(plan, AdviceSeconds);
+    if (arrangement == Arrangement::Contiguous) advice.contiguousTime = time;
+    if (time < advice.time) {
+      advice.arrangement = arrangement;
+      advice.in = inLayout;
+      advice.out = outLayout;
+      advice.time = time;
+    }
+  }
+  return advice;
+}
+
+// Planning and execute times of a transform planned with a given flag.
+using FlagCost = Tuning;
+
+// The flag recommended by PlanningAdvisor for a number of executions, along
+// with the costs of the flags measured.
+struct PlanningAdvice {
+  Flag flag = Estimate;
+  long executions = 0;
+  std::vector<FlagCost> costs;
+
+  // Return the expected time of the recommended flag.
+  double Cost() const {
+    auto it = std::ranges::find(costs, flag, &FlagCost::flag);
+    return it == costs.end() ? 0 : it->Cost(executions);
+  }
+};
+
+// Recommends the planning flag for a transform that gives the least total
+// time for planning and an expected number of executions, using a Tuner
+// that selects only among flags. Measurements are cached by plan key, and
+// a flag is only measured if it might pay for itself, so that a few
+// executions never pay for timing a Measure or Patient plan. Planning
+// times include any wisdom present when they are measured, and each
+// measurement adds its wisdom, so the plan recommended can then be made
+// cheaply.
+class PlanningAdvisor {
+ public:
+  explicit PlanningAdvisor(std::vector<Flag> flags = {Estimate, Measure,
+                                                      Patient})
+      : _tuner{Tuner::FlagsOnly(std::move(flags))} {}
+
+  // Return the advice for a transform between the layouts with the given
+  // number of executions. The remaining arguments are the direction or
+  // kinds as needed.
+  template <NumericConcepts::RealOrComplex InType,
+            NumericConcepts::RealOrComplex OutType, typename... Args>
+  requires NumericConcepts::SamePrecision<InType, OutType>
+  PlanningAdvice Advise(const Ranges::Layout& inLayout,
+                        const Ranges::Layout& outLayout, long executions,
+                        Args... args) {
+    auto best =
+        _tuner.Tune<InType, OutType>(inLayout, outLayout, executions, args...);
+    return PlanningAdvice{
+        best.flag, executions,
+        _tuner.Measured<InType, OutType>(inLayout, outLayout, args...)};
+  }
+
+  // Make the plan recommended for the views and number of executions.
+  template <NumericConcepts::RealOrComplexWritableRange InView,
+            NumericConcepts::RealOrComplexWritableRange OutView,
+            typename... Args>
+  auto MakePlan(Ranges::View<InView> in, Ranges::View<OutView> out,
+                long executions, Args... args) {
+    using InType = std::ranges::range_value_t<InView>;
+    using OutType = std::ranges::range_value_t<OutView>;
+    auto advice = Advise<InType, OutType>(in, out, executions, args...);
+    return Ranges::Plan<InView, OutView>(in, out, advice.flag, args...);
+  }
+
+  // Returns the number of flags measured over all queries.
+  auto Measurements() const { return _tuner.Measurements(); }
+
+ private:
+  Tuner _tuner;
+};
+
+}  // namespace FFTWpp
+
+#endif  // FFTWPP_ADVISOR_GUARD_H
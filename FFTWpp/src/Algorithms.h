@@ -0,0 +1,181 @@
+#ifndef FFTWPP_ALGORITHMS_GUARD_H
+#define FFTWPP_ALGORITHMS_GUARD_H
+
+#include <algorithm>
+#include <cassert>
+#include <complex>
+#include <cstddef>
+#include <execution>
+#include <numeric>
+#include <ranges>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "Core.h"
+#include "NumericConcepts/Numeric.hpp"
+#include "NumericConcepts/Ranges.hpp"
+#include "Plan.h"
+#include "Views.h"
+
+namespace FFTWpp {
+
+//-------------------------------------------------------------//
+//        Algorithms over ranges of batches of transforms      //
+//-------------------------------------------------------------//
+
+// The algorithms below apply plans to each element of a range of batches
+// using new-array execution. Each batch must have the layout of the arrays
+// used to form the plan. Parallel policies share the batches between
+// threads, while unsequenced policies vectorise the pointwise passes within
+// each batch. As executes and allocations are not allowed under unsequenced
+// policies, the loop over batches uses the sequenced or parallel policy
+// matching the one given.
+
+template <typename Policy>
+concept ExecutionPolicy =
+    std::is_execution_policy_v<std::remove_cvref_t<Policy>>;
+
+template <typename Batches>
+concept BatchRange =
+    std::ranges::random_access_range<Batches> and
+    std::ranges::sized_range<Batches> and
+    NumericConcepts::RealOrComplexWritableRange<
+        std::ranges::range_reference_t<Batches>>;
+
+// Returns true for policies that share the batches between threads.
+template <ExecutionPolicy Policy>
+constexpr bool IsParallelPolicy() {
+  using P = std::remove_cvref_t<Policy>;
+  return std::same_as<P, std::execution::parallel_policy> ||
+         std::same_as<P, std::execution::parallel_unsequenced_policy>;
+}
+
+// Returns the policy used for pointwise passes within a single batch.
+template <ExecutionPolicy Policy>
+constexpr auto InnerPolicy(Policy&&) {
+  using P = std::remove_cvref_t<Policy>;
+  if constexpr (std::same_as<P, std::execution::parallel_unsequenced_policy> ||
+                std::same_as<P, std::execution::unsequenced_policy>) {
+    return std::execution::unseq;
+  } else {
+    return std::execution::seq;
+  }
+}
+
+// Calls f(i) for each batch index i in [0, count), in parallel for
+// parallel policies and otherwise in sequence.
+template <ExecutionPolicy Policy, typename F>
+void ForEachBatch(Policy&&, std::size_t count, F f) {
+  auto indices = std::vector<std::size_t>(count);
+  std::iota(indices.begin(), indices.end(), std::size_t{0});
+  if constexpr (IsParallelPolicy<Policy>()) {
+    std::for_each(std::execution::par, indices.begin(), indices.end(), f);
+  } else {
+    std::for_each(indices.begin(), indices.end(), f);
+  }
+}
+
+// Calls f(first, last) for contiguous chunks of the batch indices in
+// [0, count), with one chunk per hardware thread for parallel policies and
+// a single chunk otherwise, so that scratch arrays are made once a chunk.
+template <ExecutionPolicy Policy, typename F>
+void ForEachChunk(Policy&& policy, std::size_t count, F f) {
+  auto chunks = std::size_t{1};
+  if constexpr (IsParallelPolicy<Policy>()) {
+    auto threads = std::max(std::thread::hardware_concurrency(), 1u);
+    chunks = std::min<std::size_t>(count, threads);
+  }
+  if (chunks == 0) return;
+  ForEachBatch(policy, chunks, [&](auto c) {
+    f(c * count / chunks, (c + 1) * count / chunks);
+  });
+}
+
+// Applies the plan to each pair of input and output batches.
+template <ExecutionPolicy Policy, BatchRange Inputs, BatchRange Outputs,
+          typename PlanType>
+void transform(Policy&& policy, Inputs&& inputs, Outputs&& outputs,
+               PlanType& plan) {
+  assert(std::ranges::size(inputs) == std::ranges::size(outputs));
+  ForEachBatch(policy, std::ranges::size(inputs), [&](auto i) {
+    plan.Execute(std::views::all(inputs[i]), std::views::all(outputs[i]));
+  });
+}
+
+// Applies a forward plan to each batch.
+template <ExecutionPolicy Policy, BatchRange Inputs, BatchRange Outputs,
+          typename PlanType>
+void forward(Policy&& policy, Inputs&& inputs, Outputs&& outputs,
+             PlanType& plan) {
+  transform(policy, inputs, outputs, plan);
+}
+
+// Applies an inverse plan to each batch and normalises the results.
+template <ExecutionPolicy Policy, BatchRange Inputs, BatchRange Outputs,
+          typename PlanType>
+void inverse(Policy&& policy, Inputs&& inputs, Outputs&& outputs,
+             PlanType& plan) {
+  assert(std::ranges::size(inputs) == std::ranges::size(outputs));
+  auto norm = plan.Normalisation();
+  auto inner = InnerPolicy(policy);
+  ForEachBatch(policy, std::ranges::size(inputs), [&](auto i) {
+    auto out = std::views::all(outputs[i]);
+    plan.Execute(std::views::all(inputs[i]), out);
+    std::transform(inner, out.begin(), out.end(), out.begin(),
+                   [norm](auto x) { return x * norm; });
+  });
+}
+
+// Forms the circular convolution of each pair of batches in lhs and rhs.
+// The forward and backward plans can be R2C and C2R or C2C pairs.
+template <ExecutionPolicy Policy, BatchRange Inputs, BatchRange Outputs,
+          typename ForwardPlan, typename BackwardPlan>
+void convolve(Policy&& policy, Inputs&& lhs, Inputs&& rhs, Outputs&& outputs,
+              ForwardPlan& forwardPlan, BackwardPlan& backwardPlan) {
+  assert(std::ranges::size(lhs) == std::ranges::size(rhs));
+  assert(std::ranges::size(lhs) == std::ranges::size(outputs));
+  using Value = std::ranges::range_value_t<
+      std::ranges::range_reference_t<decltype(outputs)>>;
+  using Spectrum = std::complex<NumericConcepts::RemoveComplex<Value>>;
+  auto size = forwardPlan.OutLayout().size();
+  auto norm = backwardPlan.Normalisation();
+  auto inner = InnerPolicy(policy);
+  ForEachChunk(policy, std::ranges::size(lhs), [&](auto first, auto last) {
+    auto a = vector<Spectrum>(size);
+    auto b = vector<Spectrum>(size);
+    for (auto i = first; i < last; i++) {
+      forwardPlan.Execute(std::views::all(lhs[i]), std::views::all(a));
+      forwardPlan.Execute(std::views::all(rhs[i]), std::views::all(b));
+      std::transform(inner, a.begin(), a.end(), b.begin(), a.begin(),
+                     [norm](auto x, auto y) { return x * y * norm; });
+      backwardPlan.Execute(std::views::all(a), std::views::all(outputs[i]));
+    }
+  });
+}
+
+// Forms the power spectrum of each batch using an R2C or C2C plan.
+template <ExecutionPolicy Policy, BatchRange Inputs, BatchRange Outputs,
+          typename PlanType>
+void power_spectrum(Policy&& policy, Inputs&& inputs, Outputs&& outputs,
+                    PlanType& plan) {
+  assert(std::ranges::size(inputs) == std::ranges::size(outputs));
+  using Real = std::ranges::range_value_t<
+      std::ranges::range_reference_t<decltype(outputs)>>;
+  auto size = plan.OutLayout().size();
+  auto inner = InnerPolicy(policy);
+  ForEachChunk(policy, std::ranges::size(inputs), [&](auto first, auto last) {
+    auto spectrum = vector<std::complex<Real>>(size);
+    for (auto i = first; i < last; i++) {
+      plan.Execute(std::views::all(inputs[i]), std::views::all(spectrum));
+      auto out = std::views::all(outputs[i]);
+      assert(std::ranges::size(out) == spectrum.size());
+      std::transform(inner, spectrum.begin(), spectrum.end(), out.begin(),
+                     [](auto z) { return std::norm(z); });
+    }
+  });
+}
+
+}  // namespace FFTWpp
+
+#endif  // FFTWPP_ALGORITHMS_GUARD_H
@@ -2,14 +2,20 @@
 #ifndef FFTWPP_CORE_GUARD_H
 #define FFTWPP_CORE_GUARD_H
 
+#include <array>
 #include <cassert>
 #include <complex>
 #include <concepts>
 #include <memory>
+#include <mutex>
+#include <string>
+#include <type_traits>
 #include <variant>
 #include <vector>
 
+#include "Memory.h"
 #include "NumericConcepts/Numeric.hpp"
+#include "Trace.h"
 #include "fftw3.h"
 
 namespace FFTWpp {
@@ -32,17 +38,43 @@ concept CheckPrecision =
 //                    Custom fftw3 allocator                    //
 //--------------------------------------------------------------//
 
+// Allocations are recorded by element type and by the tag of the call site
+// at which the allocator was constructed. Allocators move with the arrays
+// they own so that arrays are released under the tag they were allocated
+// with. On copy assignment an array keeps its allocator, as the storage it
+// reuses was recorded under its own tag.
 template <typename T>
 class Allocator {
  public:
   using value_type = T;
-  Allocator() noexcept {}
+  using propagate_on_container_copy_assignment = std::false_type;
+  using propagate_on_container_move_assignment = std::true_type;
+  using propagate_on_container_swap = std::true_type;
+  using is_always_equal = std::true_type;
+  Allocator() noexcept : _tag{Memory::CurrentTag()} {}
+  explicit Allocator(const char* tag) noexcept : _tag{tag} {}
   template <class U>
-  Allocator(const Allocator<U>&) noexcept {}
+  Allocator(const Allocator<U>& other) noexcept : _tag{other.Tag()} {}
   T* allocate(std::size_t n) {
-    return static_cast<T*>(fftw_malloc(sizeof(T) * n));
+    auto trace = ScopedTrace("Allocate", "memory");
+    if (trace.Active()) trace.Detail(std::to_string(sizeof(T) * n) + " bytes");
+    auto p = static_cast<T*>(fftw_malloc(sizeof(T) * n));
+    if (p) Memory::Accounts::Get().Allocate(Type(), _tag, sizeof(T) * n);
+    return p;
+  }
+  void deallocate(T* p, std::size_t n) {
+    fftw_free(p);
+    Memory::Accounts::Get().Deallocate(Type(), _tag, sizeof(T) * n);
+  }
+  const char* Tag() const noexcept { return _tag; }
+
+ private:
+  const char* _tag;
+
+  static const char* Type() {
+    static const auto type = Memory::TypeName<T>();
+    return type.c_str();
   }
-  void deallocate(T* p, std::size_t n) { fftw_free(p); }
 };
 
 template <class T, class U>
@@ -58,7 +90,17 @@ constexpr bool operator!=(const Allocator<T>&, const Allocator<U>&) noexcept {
 template <typename T>
 using vector = std::vector<T, Allocator<T>>;
 
+// Returns the mutex serialising calls into the fftw3 planner, which unlike
+// execution is not thread-safe. It is held by FFTWpp while plans are made
+// or destroyed and while wisdom is used, so that plans can be made on
+// background threads.
+inline std::recursive_mutex& PlannerMutex() {
+  static auto* mutex = new std::recursive_mutex;
+  return *mutex;
+}
+
 void CleanUp() {
+  auto lock = std::scoped_lock(PlannerMutex());
   fftwf_cleanup();
   fftw_cleanup();
   fftwl_cleanup();
@@ -77,6 +119,26 @@ auto ComplexCast(std::complex<Real>* z) {
   }
 }
 
+// Returns the fftw3 alignment of the pointer. New-array execute
+// functions require this to match that of the arrays used in planning.
+template <NumericConcepts::Real Real>
+int AlignmentOf(Real* p) {
+  if constexpr (NumericConcepts::Float<Real>) {
+    return fftwf_alignment_of(p);
+  }
+  if constexpr (NumericConcepts::Double<Real>) {
+    return fftw_alignment_of(p);
+  }
+  if constexpr (NumericConcepts::LongDouble<Real>) {
+    return fftwl_alignment_of(p);
+  }
+}
+
+template <NumericConcepts::Real Real>
+int AlignmentOf(std::complex<Real>* z) {
+  return AlignmentOf(reinterpret_cast<Real*>(z));
+}
+
 //----------------------------------------------------------//
 //                         1D plans                         //
 //----------------------------------------------------------//
@@ -496,6 +558,30 @@ void Execute(PlanType plan, Real* in, Real* out) {
   }
 }
 
+//----------------------------------------------------------//
+//                 Plan information functions               //
+//----------------------------------------------------------//
+
+// Returns the additions, multiplications and fused multiply-adds counted by
+// fftw3 for an execute of the plan.
+template <IsPlan PlanType>
+std::array<double, 3> Flops(PlanType plan) {
+  assert(plan != nullptr);
+  auto add = 0.0;
+  auto mul = 0.0;
+  auto fma = 0.0;
+  if constexpr (std::same_as<PlanType, fftwf_plan>) {
+    fftwf_flops(plan, &add, &mul, &fma);
+  }
+  if constexpr (std::same_as<PlanType, fftw_plan>) {
+    fftw_flops(plan, &add, &mul, &fma);
+  }
+  if constexpr (std::same_as<PlanType, fftwl_plan>) {
+    fftwl_flops(plan, &add, &mul, &fma);
+  }
+  return {add, mul, fma};
+}
+
 }  // namespace FFTWpp
 
 #endif  // FFTWPP_MEMORY_GUARD_H
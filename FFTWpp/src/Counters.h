@@ -0,0 +1,262 @@
+#ifndef FFTWPP_COUNTERS_GUARD_H
+#define FFTWPP_COUNTERS_GUARD_H
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "Timing.h"
+#include "Views.h"
+
+namespace FFTWpp {
+
+// Values of the hardware counters over a period of execution.
+struct CounterValues {
+  std::uint64_t cycles = 0;
+  std::uint64_t instructions = 0;
+  std::uint64_t cacheReferences = 0;  // Last-level cache references.
+  std::uint64_t cacheMisses = 0;      // Last-level cache misses.
+
+  CounterValues& operator+=(const CounterValues& other) {
+    cycles += other.cycles;
+    instructions += other.instructions;
+    cacheReferences += other.cacheReferences;
+    cacheMisses += other.cacheMisses;
+    return *this;
+  }
+};
+
+// A group of hardware counters for the calling thread, read through the
+// Linux perf_event_open interface. Counting is restricted to user space,
+// and to the thread that opened the group, so work on other threads is not
+// counted. When the kernel multiplexes more events than the hardware has
+// counters, the counts are scaled by the fraction of time the group ran.
+// Where the counters cannot be opened, as in many containers or with a
+// restrictive perf_event_paranoid setting, the group is unavailable and
+// reads return zeros.
+class PerfCounters {
+ public:
+  PerfCounters() {
+#if defined(__linux__)
+    constexpr auto events = std::array{
+        PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_REFERENCES, PERF_COUNT_HW_CACHE_MISSES};
+    for (auto event : events) {
+      auto attr = perf_event_attr{};
+      attr.type = PERF_TYPE_HARDWARE;
+      attr.size = sizeof(attr);
+      attr.config = event;
+      attr.disabled = _fds.empty();
+      attr.exclude_kernel = 1;
+      attr.exclude_hv = 1;
+      attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED |
+                         PERF_FORMAT_TOTAL_TIME_RUNNING;
+      auto group = _fds.empty() ? -1 : _fds.front();
+      auto fd = static_cast<int>(
+          syscall(SYS_perf_event_open, &attr, 0, -1, group, 0));
+      if (fd < 0) {
+        Close();
+        return;
+      }
+      _fds.push_back(fd);
+    }
+#endif
+  }
+
+  PerfCounters(const PerfCounters&) = delete;
+  PerfCounters& operator=(const PerfCounters&) = delete;
+
+  ~PerfCounters() { Close(); }
+
+  // Returns true if the counters could be opened.
+  bool Available() const { return !_fds.empty(); }
+
+  // Reset and start the counters.
+  void Start() {
+#if defined(__linux__)
+    if (!Available()) return;
+    ioctl(_fds.front(), PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(_fds.front(), PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#endif
+  }
+
+  // Stop the counters, returning their values since the start, scaled for
+  // any time the group was not scheduled. If it was never scheduled the
+  // values are zero.
+  CounterValues Stop() {
+    auto values = CounterValues{};
+#if defined(__linux__)
+    if (!Available()) return values;
+    ioctl(_fds.front(), PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+    // The number of events, the times enabled and running, and the counts.
+    auto data = std::array<std::uint64_t, 7>{};
+    if (read(_fds.front(), data.data(), sizeof(data)) !=
+        static_cast<ssize_t>(sizeof(data))) {
+      return values;
+    }
+    auto enabled = data[1];
+    auto running = data[2];
+    if (running == 0) return values;
+    auto scale = [&](std::uint64_t count) {
+      if (running >= enabled) return count;
+      return static_cast<std::uint64_t>(static_cast<double>(count) * enabled /
+                                        running);
+    };
+    values.cycles = scale(data[3]);
+    values.instructions = scale(data[4]);
+    values.cacheReferences = scale(data[5]);
+    values.cacheMisses = scale(data[6]);
+#endif
+    return values;
+  }
+
+ private:
+  std::vector<int> _fds;
+
+  void Close() {
+#if defined(__linux__)
+    for (auto fd : _fds) close(fd);
+#endif
+    _fds.clear();
+  }
+};
+
+// Counters and times of the executes of plans with a given key.
+struct CounterReport {
+  std::string key;
+  long executes = 0;
+  double seconds = 0;
+  double flops = 0;  // Nominal floating-point operations.
+  CounterValues counters;
+  bool available = false;  // True if the hardware counters were read.
+
+  // Return the instructions per cycle.
+  double IPC() const {
+    return counters.cycles ? static_cast<double>(counters.instructions) /
+                                 counters.cycles
+                           : 0;
+  }
+
+  // Return the nominal rate in GFLOP/s.
+  double GFlops() const { return seconds > 0 ? flops / seconds * 1e-9 : 0; }
+
+  // Return the bytes moved from memory, estimated as a cache line per
+  // last-level cache miss.
+  double MemoryBytes() const {
+    return static_cast<double>(counters.cacheMisses) * CacheLineBytes;
+  }
+
+  // Return the memory bandwidth in GB/s.
+  double Bandwidth() const {
+    return seconds > 0 ? MemoryBytes() / seconds * 1e-9 : 0;
+  }
+
+  // Return the bytes moved from memory per nominal flop. High values
+  // indicate a transform limited by memory rather than by arithmetic.
+  double BytesPerFlop() const { return flops > 0 ? MemoryBytes() / flops : 0; }
+
+  // Return the fraction of last-level cache references that missed.
+  double MissRate() const {
+    return counters.cacheReferences
+               ? static_cast<double>(counters.cacheMisses) /
+                     counters.cacheReferences
+               : 0;
+  }
+};
+
+// Samples the hardware counters around plan executes, grouping the results
+// by plan key. Each thread uses its own counter group, opened on first use,
+// which counts only that thread, so work that a plan hands to the workers
+// of a thread pool appears in the times but not in the counts.
+// Where the counters are unavailable, executes and times are still
+// recorded.
+class CounterProfiler {
+ public:
+  // Execute the plan with counting.
+  template <typename PlanType>
+  void Execute(PlanType& plan) {
+    auto& counters = ThreadCounters();
+    auto start = std::chrono::steady_clock::now();
+    counters.Start();
+    plan.Execute();
+    auto values = counters.Stop();
+    auto seconds = Seconds(start);
+
+    auto key = plan.Key();
+    auto flops = NominalFlops(plan);
+    auto lock = std::scoped_lock(_mutex);
+    auto& report = _reports[key];
+    report.key = key;
+    report.executes++;
+    report.seconds += seconds;
+    report.flops += flops;
+    report.counters += values;
+    report.available = counters.Available();
+  }
+
+  // Returns true if the counters are available on the calling thread.
+  static bool Available() { return ThreadCounters().Available(); }
+
+  // Return the reports for each plan key.
+  std::vector<CounterReport> Reports() {
+    auto lock = std::scoped_lock(_mutex);
+    auto reports = std::vector<CounterReport>();
+    for (const auto& [key, report] : _reports) reports.push_back(report);
+    return reports;
+  }
+
+  // Write the reports as a table.
+  void Print(std::ostream& stream) {
+    auto flags = stream.flags();
+    auto precision = stream.precision(3);
+    stream << std::fixed << std::setw(10) << "executes" << std::setw(12)
+           << "GFLOP/s" << std::setw(8) << "IPC" << std::setw(12) << "miss rate"
+           << std::setw(12) << "GB/s" << std::setw(12) << "bytes/flop"
+           << "  key\n";
+    for (const auto& report : Reports()) {
+      stream << std::setw(10) << report.executes << std::setw(12)
+             << report.GFlops();
+      if (report.available) {
+        stream << std::setw(8) << report.IPC() << std::setw(12)
+               << report.MissRate() << std::setw(12) << report.Bandwidth()
+               << std::setw(12) << report.BytesPerFlop();
+      } else {
+        stream << std::setw(44) << "counters unavailable";
+      }
+      stream << "  " << report.key << "\n";
+    }
+    stream.flags(flags);
+    stream.precision(precision);
+  }
+
+  void Clear() {
+    auto lock = std::scoped_lock(_mutex);
+    _reports.clear();
+  }
+
+ private:
+  std::mutex _mutex;
+  std::map<std::string, CounterReport> _reports;
+
+  static PerfCounters& ThreadCounters() {
+    thread_local auto counters = PerfCounters();
+    return counters;
+  }
+};
+
+}  // namespace FFTWpp
+
+#endif  // FFTWPP_COUNTERS_GUARD_H
@@ -0,0 +1,98 @@
+#ifndef FFTWPP_DENORMALS_GUARD_H
+#define FFTWPP_DENORMALS_GUARD_H
+
+#include <cmath>
+#include <complex>
+
+#if defined(__SSE__) || defined(_M_X64)
+#include <xmmintrin.h>
+#endif
+
+#include "NumericConcepts/Numeric.hpp"
+
+namespace FFTWpp {
+
+// True if the handling of subnormal values can be controlled. On x86 this
+// is through the flush-to-zero and denormals-are-zero bits of the MXCSR
+// register, and on AArch64 through the flush-to-zero bit of the FPCR. These
+// affect float and double arithmetic, but not x87 long double arithmetic.
+#if defined(__SSE__) || defined(_M_X64) || defined(__aarch64__)
+constexpr bool HasDenormalControl = true;
+#else
+constexpr bool HasDenormalControl = false;
+#endif
+
+// Return the floating-point control state of the calling thread.
+inline unsigned DenormalState() {
+#if defined(__SSE__) || defined(_M_X64)
+  return _mm_getcsr();
+#elif defined(__aarch64__)
+  return __builtin_aarch64_get_fpcr();
+#else
+  return 0;
+#endif
+}
+
+// Set the floating-point control state of the calling thread.
+inline void SetDenormalState([[maybe_unused]] unsigned state) {
+#if defined(__SSE__) || defined(_M_X64)
+  _mm_setcsr(state);
+#elif defined(__aarch64__)
+  __builtin_aarch64_set_fpcr(state);
+#endif
+}
+
+// Return the given control state with subnormal values flushed to zero.
+inline unsigned FlushedDenormalState(unsigned state) {
+#if defined(__SSE__) || defined(_M_X64)
+  return state | 0x8040;  // Flush-to-zero and denormals-are-zero.
+#elif defined(__aarch64__)
+  return state | (1u << 24);  // Flush-to-zero.
+#else
+  return state;
+#endif
+}
+
+// Sets the floating-point control state of the calling thread for the
+// lifetime of the object, restoring the previous state afterwards.
+class ScopedDenormalState {
+ public:
+  // Flush subnormals to zero if requested, or otherwise leave the state.
+  explicit ScopedDenormalState(bool flush)
+      : _previous{DenormalState()}, _active{flush} {
+    if (_active) SetDenormalState(FlushedDenormalState(_previous));
+  }
+
+  // Use the given state, as captured from another thread.
+  explicit ScopedDenormalState(unsigned state)
+      : _previous{DenormalState()}, _active{state != _previous} {
+    if (_active) SetDenormalState(state);
+  }
+
+  ScopedDenormalState(const ScopedDenormalState&) = delete;
+  ScopedDenormalState& operator=(const ScopedDenormalState&) = delete;
+
+  ~ScopedDenormalState() {
+    if (_active) SetDenormalState(_previous);
+  }
+
+ private:
+  unsigned _previous;
+  bool _active;
+};
+
+// Returns true if the value, or either part of a complex value, is
+// subnormal.
+template <NumericConcepts::RealOrComplex T>
+bool IsSubnormal(T value) {
+  if constexpr (NumericConcepts::Complex<T>) {
+    return std::fpclassify(value.real()) == FP_SUBNORMAL ||
+           std::fpclassify(value.imag()) == FP_SUBNORMAL;
+  } else {
+    return std::fpclassify(value) == FP_SUBNORMAL;
+  }
+}
+
+}  // namespace FFTWpp
+
+#endif  // FFTWPP_DENORMALS_GUARD_H
@@ -0,0 +1,535 @@
+#ifndef FFTWPP_FIXED_GUARD_H
+#define FFTWPP_FIXED_GUARD_H
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cassert>
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <numbers>
+#include <optional>
+#include <ranges>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "Core.h"
+#include "NumericConcepts/Numeric.hpp"
+#include "NumericConcepts/Ranges.hpp"
+#include "Options.h"
+#include "Plan.h"
+#include "Views.h"
+#include "fftw3.h"
+
+namespace FFTWpp {
+
+// Largest dimension handled by the fixed-size kernels. One-dimensional
+// complex, R2C and C2R transforms of power-of-two size use radix-2
+// butterflies, whose cost of about 5 n log2(n) flops is close to that of
+// fftw3's codelets, so they are used up to this size.
+constexpr int FixedMaxSize = 64;
+
+// Largest dimension along any axis handled by dense matrix kernels, which
+// are used for other sizes and for each axis of R2R transforms. These cost
+// about 4 n^2 flops for a complex transform, which at 16 is three times
+// the butterflies but still below the per-execute overhead of fftw3 for
+// a single transform. Beyond it, fftw3 is faster even for single
+// transforms, as the FixedSize benchmark shows.
+constexpr int FixedMaxDenseSize = 16;
+
+// Largest number of elements per transform handled by the fixed-size kernels.
+constexpr int FixedMaxElements = 256;
+
+// Number of transforms processed together by the fixed-size kernels. The
+// innermost loops run across this many transforms, which lets the compiler
+// vectorise them irrespective of the data layout.
+constexpr int FixedBatchWidth = 8;
+
+namespace Ranges {
+
+// Plan for transforms whose dimensions are known at compile time. Small
+// sizes are computed by unrolled kernels that avoid the per-execute overhead
+// of fftw3, using radix-2 butterflies where possible and dense matrices
+// otherwise, while larger sizes fall back to a Ranges::Plan. The dimensions
+// given are those of the logical (real-side) transform, as passed to Layout.
+template <NumericConcepts::RealOrComplexWritableRange InView,
+          NumericConcepts::RealOrComplexWritableRange OutView, int... Ns>
+requires NumericConcepts::SameRangePrecision<InView, OutView> and
+         (sizeof...(Ns) > 0) and ((Ns > 0) && ...)
+class FixedPlan {
+  using InType = std::ranges::range_value_t<InView>;
+  using OutType = std::ranges::range_value_t<OutView>;
+  using Real = NumericConcepts::RemoveComplex<InType>;
+
+  static constexpr auto _rank = static_cast<int>(sizeof...(Ns));
+  static constexpr auto _n = std::array<int, sizeof...(Ns)>{Ns...};
+  static constexpr auto _elements = (Ns * ...);
+  static constexpr auto _half = _n.back() / 2 + 1;
+
+  // True if the kernel uses radix-2 butterflies rather than matrices.
+  static constexpr bool _butterfly =
+      _rank == 1 &&
+      (NumericConcepts::Complex<InType> || NumericConcepts::Complex<OutType>) &&
+      _n.back() > 1 && std::has_single_bit(static_cast<unsigned>(_n.back()));
+
+  static constexpr auto _inComponents =
+      NumericConcepts::Complex<InType> ? 2 : 1;
+  static constexpr auto _outComponents =
+      NumericConcepts::Complex<OutType> ? 2 : 1;
+
+  // Number of real values making up a single input or output transform.
+  static constexpr auto _inSize =
+      NumericConcepts::Complex<InType> && NumericConcepts::Real<OutType>
+          ? 2 * _half
+          : _inComponents * _elements;
+  static constexpr auto _outSize =
+      NumericConcepts::Real<InType> && NumericConcepts::Complex<OutType>
+          ? 2 * _half
+          : _outComponents * _elements;
+
+ public:
+  // True if the transform is computed using the fixed-size kernels.
+  static constexpr bool HasKernel =
+      ((NumericConcepts::Real<InType> && NumericConcepts::Real<OutType>) ||
+       _rank == 1) &&
+      std::ranges::max(_n) <=
+          (_butterfly ? FixedMaxSize : FixedMaxDenseSize) &&
+      _elements <= FixedMaxElements;
+
+  // Remove default constructor.
+  FixedPlan() = delete;
+
+  // Constructor for C2C.
+  FixedPlan(View<InView> in, View<OutView> out, Flag flag, Direction direction)
+  requires NumericConcepts::Complex<InType> and
+               NumericConcepts::Complex<OutType>
+      : _in{in}, _out{out}, _direction{direction} {
+    assert(CheckInputs());
+    if constexpr (HasKernel) {
+      MakeKernel();
+    } else {
+      _plan.emplace(_in, _out, flag, direction);
+    }
+  }
+
+  // Constructor for R2C or C2R.
+  FixedPlan(View<InView> in, View<OutView> out, Flag flag)
+  requires(NumericConcepts::Complex<InType> and
+           NumericConcepts::Real<OutType>) or
+              (NumericConcepts::Real<InType> and
+               NumericConcepts::Complex<OutType>)
+      : _in{in}, _out{out} {
+    assert(CheckInputs());
+    if constexpr (HasKernel) {
+      MakeKernel();
+    } else {
+      _plan.emplace(_in, _out, flag);
+    }
+  }
+
+  // Constructor for R2R.
+  template <typename... RealKinds>
+  requires(sizeof...(RealKinds) > 0) and
+              (std::same_as<RealKinds, RealKind> && ...)
+  FixedPlan(View<InView> in, View<OutView> out, Flag flag, RealKinds... kinds)
+      : _in{in}, _out{out}, _kinds{kinds...} {
+    assert(_kinds.size() <= _rank);
+    while (_kinds.size() < _rank) {
+      _kinds.push_back(_kinds.back());
+    }
+    assert(CheckInputs());
+    if constexpr (HasKernel) {
+      MakeKernel();
+    } else {
+      _plan.emplace(_in, _out, flag, kinds...);
+    }
+  }
+
+  // Normalisation factor for inverse transformations.
+  auto Normalisation() const {
+    int dim;
+    if constexpr (NumericConcepts::Complex<InType> ||
+                  NumericConcepts::Complex<OutType>) {
+      dim = std::ranges::fold_left_first(_out.N(), std::multiplies<>()).value();
+    } else {
+      dim = std::ranges::fold_left_first(
+                std::ranges::views::zip_transform(
+                    [](auto n, auto kind) { return kind.LogicalDimension(n); },
+                    _out.N(), std::ranges::views::all(_kinds)),
+                std::multiplies<>())
+                .value();
+    }
+    return static_cast<OutType>(1) / static_cast<OutType>(dim);
+  }
+
+  // Execute the plan.
+  void Execute() {
+    if constexpr (HasKernel) {
+      Apply(_in.DataPointer(), _out.DataPointer());
+    } else {
+      _plan->Execute();
+    }
+  }
+
+  // Execute using new data.
+  template <NumericConcepts::RealOrComplexWritableRange NewInView,
+            NumericConcepts::RealOrComplexWritableRange NewOutView>
+  requires NumericConcepts::SameRangeValueType<InView, NewInView> &&
+           NumericConcepts::SameRangeValueType<OutView, NewOutView>
+  void Execute(NewInView in, NewOutView out) {
+    if constexpr (HasKernel) {
+      Apply(in.data(), out.data());
+    } else {
+      _plan->Execute(in, out);
+    }
+  }
+
+ private:
+  View<InView> _in;
+  View<OutView> _out;
+  std::variant<std::monostate, Direction> _direction;
+  std::vector<RealKind> _kinds;
+
+  // Fallback plan used when there is no kernel.
+  std::optional<Plan<InView, OutView>> _plan;
+
+  // Kernel matrices, one per axis for R2R and a single one otherwise.
+  std::vector<vector<Real>> _matrices;
+
+  // Real and imaginary parts of the butterfly twiddle factors, and the
+  // bit-reversed order of the points.
+  vector<Real> _twiddles;
+  std::vector<int> _reversed;
+
+  // Offsets of the real components of a transform relative to its start.
+  std::vector<std::ptrdiff_t> _inOffsets;
+  std::vector<std::ptrdiff_t> _outOffsets;
+
+  // Offsets between transforms in units of Real.
+  std::ptrdiff_t _inDist;
+  std::ptrdiff_t _outDist;
+
+  // Work space holding two blocks of FixedBatchWidth transforms.
+  static constexpr auto _workSize =
+      std::max({_inSize, _outSize, 2 * _n.back()}) * FixedBatchWidth;
+  vector<Real> _work;
+
+  auto CheckInputs() const {
+    if (_in.Rank() != _rank || _out.Rank() != _rank) return false;
+    if (_in.HowMany() != _out.HowMany()) return false;
+    auto realN = NumericConcepts::Real<InType> ? _in.N() : _out.N();
+    if (!std::ranges::equal(realN, _n)) return false;
+    if constexpr (!std::same_as<InType, OutType>) {
+      auto complexN = NumericConcepts::Complex<InType> ? _in.N() : _out.N();
+      return std::ranges::equal(complexN | std::views::take(_rank - 1),
+                                _n | std::views::take(_rank - 1)) &&
+             complexN.back() == _half;
+    }
+    return true;
+  }
+
+  // Returns cos(pi m / l) and sin(pi m / l) with m reduced modulo 2l so that
+  // the matrices are accurate to the working precision.
+  static auto Phase(long m, long l) {
+    m %= 2 * l;
+    auto theta = std::numbers::pi_v<long double> * static_cast<long double>(m) /
+                 static_cast<long double>(l);
+    return std::pair{std::cos(theta), std::sin(theta)};
+  }
+
+  // Coefficient mapping the jth input to the kth output of an n-point
+  // real-to-real transform, following the fftw3 definitions.
+  static long double Coefficient(RealKind kind, int n, int j, int k) {
+    auto parity = k % 2 == 0 ? 1.0L : -1.0L;
+    switch (static_cast<fftw_r2r_kind>(kind)) {
+      case FFTW_R2HC:
+        if (2 * k <= n) return Phase(2L * j * k, n).first;
+        return -Phase(2L * j * (n - k), n).second;
+      case FFTW_HC2R:
+        if (j == 0) return 1;
+        if (2 * j == n) return parity;
+        if (2 * j < n) return 2 * Phase(2L * j * k, n).first;
+        return -2 * Phase(2L * (n - j) * k, n).second;
+      case FFTW_DHT: {
+        auto [c, s] = Phase(2L * j * k, n);
+        return c + s;
+      }
+      case FFTW_REDFT00:
+        if (j == 0) return 1;
+        if (j == n - 1) return parity;
+        return 2 * Phase(static_cast<long>(j) * k, n - 1).first;
+      case FFTW_REDFT10:
+        return 2 * Phase((2L * j + 1) * k, 2 * n).first;
+      case FFTW_REDFT01:
+        if (j == 0) return 1;
+        return 2 * Phase(j * (2L * k + 1), 2 * n).first;
+      case FFTW_REDFT11:
+        return 2 * Phase((2L * j + 1) * (2 * k + 1), 4 * n).first;
+      case FFTW_RODFT00:
+        return 2 * Phase((j + 1L) * (k + 1), n + 1).second;
+      case FFTW_RODFT10:
+        return 2 * Phase((2L * j + 1) * (k + 1), 2 * n).second;
+      case FFTW_RODFT01:
+        if (j == n - 1) return parity;
+        return 2 * Phase((j + 1L) * (2 * k + 1), 2 * n).second;
+      case FFTW_RODFT11:
+        return 2 * Phase((2L * j + 1) * (2 * k + 1), 4 * n).second;
+      default:
+        return 0;
+    }
+  }
+
+  // Builds the kernel matrices or twiddle factors, the offset tables and
+  // the work space.
+  void MakeKernel() {
+    constexpr auto n = _n.back();
+    if constexpr (_butterfly) {
+      auto sign = -1.0L;
+      if constexpr (NumericConcepts::Complex<InType> &&
+                    NumericConcepts::Complex<OutType>) {
+        sign = static_cast<long double>(std::get<Direction>(_direction));
+      } else if constexpr (NumericConcepts::Complex<InType>) {
+        sign = 1.0L;
+      }
+      _twiddles = vector<Real>(n);
+      for (auto t = 0; t < n / 2; t++) {
+        auto [c, s] = Phase(2L * t, n);
+        _twiddles[2 * t] = c;
+        _twiddles[2 * t + 1] = sign * s;
+      }
+      constexpr auto bits = std::countr_zero(static_cast<unsigned>(n));
+      for (auto j = 0; j < n; j++) {
+        auto r = 0;
+        for (auto b = 0; b < bits; b++) r |= ((j >> b) & 1) << (bits - 1 - b);
+        _reversed.push_back(r);
+      }
+    } else if constexpr (NumericConcepts::Complex<InType> &&
+                         NumericConcepts::Complex<OutType>) {
+      auto sign = static_cast<long double>(std::get<Direction>(_direction));
+      auto matrix = vector<Real>(_outSize * _inSize);
+      for (auto k = 0; k < n; k++) {
+        for (auto j = 0; j < n; j++) {
+          auto [c, s] = Phase(2L * j * k, n);
+          s *= sign;
+          matrix[(2 * k) * _inSize + 2 * j] = c;
+          matrix[(2 * k) * _inSize + 2 * j + 1] = -s;
+          matrix[(2 * k + 1) * _inSize + 2 * j] = s;
+          matrix[(2 * k + 1) * _inSize + 2 * j + 1] = c;
+        }
+      }
+      _matrices.push_back(std::move(matrix));
+    } else if constexpr (NumericConcepts::Real<InType> &&
+                         NumericConcepts::Complex<OutType>) {
+      auto matrix = vector<Real>(_outSize * _inSize);
+      for (auto k = 0; k < _half; k++) {
+        for (auto j = 0; j < n; j++) {
+          auto [c, s] = Phase(2L * j * k, n);
+          matrix[(2 * k) * _inSize + j] = c;
+          matrix[(2 * k + 1) * _inSize + j] = -s;
+        }
+      }
+      _matrices.push_back(std::move(matrix));
+    } else if constexpr (NumericConcepts::Complex<InType> &&
+                         NumericConcepts::Real<OutType>) {
+      auto matrix = vector<Real>(_outSize * _inSize);
+      for (auto j = 0; j < n; j++) {
+        for (auto k = 0; k < _half; k++) {
+          auto [c, s] = Phase(2L * j * k, n);
+          // The imaginary parts of the zero and Nyquist terms are ignored.
+          auto edge = k == 0 || 2 * k == n;
+          matrix[j * _inSize + 2 * k] = (edge ? 1.0L : 2.0L) * c;
+          matrix[j * _inSize + 2 * k + 1] = edge ? 0.0L : -2.0L * s;
+        }
+      }
+      _matrices.push_back(std::move(matrix));
+    } else {
+      for (auto axis = 0; axis < _rank; axis++) {
+        auto m = _n[axis];
+        auto matrix = vector<Real>(m * m);
+        for (auto k = 0; k < m; k++) {
+          for (auto j = 0; j < m; j++) {
+            matrix[k * m + j] = Coefficient(_kinds[axis], m, j, k);
+          }
+        }
+        _matrices.push_back(std::move(matrix));
+      }
+    }
+    _inOffsets = Offsets(_in, _inComponents);
+    _outOffsets = Offsets(_out, _outComponents);
+    _inDist = static_cast<std::ptrdiff_t>(_inComponents) * _in.Dist();
+    _outDist = static_cast<std::ptrdiff_t>(_outComponents) * _out.Dist();
+    _work = vector<Real>(2 * _workSize);
+  }
+
+  // Offsets of each real component of a transform within the given view.
+  template <typename V>
+  static auto Offsets(V& view, int components) {
+    auto n = std::vector<int>(view.N().begin(), view.N().end());
+    auto embed = std::vector<int>(view.Embed().begin(), view.Embed().end());
+    auto elements =
+        std::ranges::fold_left_first(n, std::multiplies<>()).value();
+    auto offsets = std::vector<std::ptrdiff_t>();
+    offsets.reserve(elements * components);
+    for (auto e = 0; e < elements; e++) {
+      auto flat = std::ptrdiff_t{0};
+      auto scale = std::ptrdiff_t{1};
+      auto index = e;
+      for (auto axis = _rank - 1; axis >= 0; axis--) {
+        flat += scale * (index % n[axis]);
+        index /= n[axis];
+        scale *= embed[axis];
+      }
+      for (auto c = 0; c < components; c++) {
+        offsets.push_back(components * view.Stride() * flat + c);
+      }
+    }
+    return offsets;
+  }
+
+  // Applies a Rows x Cols matrix along the middle index of a work block
+  // arranged as [Outer][Cols][Inner][FixedBatchWidth].
+  template <int Outer, int Rows, int Cols, int Inner>
+  static void Pass(const Real* matrix, const Real* x, Real* y) {
+    for (auto o = 0; o < Outer; o++) {
+      for (auto r = 0; r < Rows; r++) {
+        for (auto i = 0; i < Inner; i++) {
+          auto acc = std::array<Real, FixedBatchWidth>{};
+          for (auto c = 0; c < Cols; c++) {
+            auto w = matrix[r * Cols + c];
+            auto src = x + ((o * Cols + c) * Inner + i) * FixedBatchWidth;
+            for (auto l = 0; l < FixedBatchWidth; l++) {
+              acc[l] += w * src[l];
+            }
+          }
+          auto dst = y + ((o * Rows + r) * Inner + i) * FixedBatchWidth;
+          std::ranges::copy(acc, dst);
+        }
+      }
+    }
+  }
+
+  // Applies the radix-2 stages in place to n complex points arranged as
+  // [n][2][FixedBatchWidth] in bit-reversed order.
+  void Butterflies(Real* y) const {
+    constexpr auto n = _n.back();
+    constexpr auto w = FixedBatchWidth;
+    for (auto m = 2; m <= n; m *= 2) {
+      for (auto s = 0; s < n; s += m) {
+        for (auto t = 0; t < m / 2; t++) {
+          auto wr = _twiddles[2 * t * (n / m)];
+          auto wi = _twiddles[2 * t * (n / m) + 1];
+          auto a = y + 2 * (s + t) * w;
+          auto b = y + 2 * (s + t + m / 2) * w;
+          for (auto l = 0; l < w; l++) {
+            auto br = b[l] * wr - b[w + l] * wi;
+            auto bi = b[l] * wi + b[w + l] * wr;
+            b[l] = a[l] - br;
+            b[w + l] = a[w + l] - bi;
+            a[l] += br;
+            a[w + l] += bi;
+          }
+        }
+      }
+    }
+  }
+
+  // Transforms a gathered block using butterflies, returning a pointer to
+  // the result. Real inputs are given zero imaginary parts, and the full
+  // spectrum of a C2R transform is formed from its Hermitian symmetry.
+  Real* ButterflyTransform(Real* x, Real* y) const {
+    constexpr auto n = _n.back();
+    constexpr auto w = FixedBatchWidth;
+    for (auto j = 0; j < n; j++) {
+      auto dst = y + 2 * _reversed[j] * w;
+      if constexpr (NumericConcepts::Real<InType>) {
+        std::copy_n(x + j * w, w, dst);
+        std::fill_n(dst + w, w, Real{0});
+      } else if constexpr (NumericConcepts::Real<OutType>) {
+        // The imaginary parts of the zero and Nyquist terms are ignored.
+        auto k = j < _half ? j : n - j;
+        auto src = x + 2 * k * w;
+        auto sign = j < _half ? Real{1} : Real{-1};
+        std::copy_n(src, w, dst);
+        for (auto l = 0; l < w; l++) {
+          dst[w + l] = k == 0 || 2 * k == n ? Real{0} : sign * src[w + l];
+        }
+      } else {
+        std::copy_n(x + 2 * j * w, 2 * w, dst);
+      }
+    }
+    Butterflies(y);
+    if constexpr (NumericConcepts::Real<OutType>) {
+      for (auto j = 0; j < n; j++) std::copy_n(y + 2 * j * w, w, x + j * w);
+      return x;
+    } else {
+      return y;
+    }
+  }
+
+  // Transforms a gathered block, returning a pointer to the result.
+  Real* Transform(Real* x, Real* y) {
+    if constexpr (_butterfly) {
+      return ButterflyTransform(x, y);
+    } else if constexpr (NumericConcepts::Real<InType> &&
+                  NumericConcepts::Real<OutType>) {
+      [&]<std::size_t... Axes>(std::index_sequence<Axes...>) {
+        (
+            [&] {
+              constexpr auto outer = std::ranges::fold_left(
+                  _n | std::views::take(Axes), 1, std::multiplies<>());
+              constexpr auto inner = std::ranges::fold_left(
+                  _n | std::views::drop(Axes + 1), 1, std::multiplies<>());
+              constexpr auto m = _n[Axes];
+              Pass<outer, m, m, inner>(_matrices[Axes].data(), x, y);
+              std::swap(x, y);
+            }(),
+            ...);
+      }(std::make_index_sequence<_rank>{});
+      return x;
+    } else {
+      Pass<1, _outSize, _inSize, 1>(_matrices.front().data(), x, y);
+      return y;
+    }
+  }
+
+  // Applies the kernel to all transforms, FixedBatchWidth at a time.
+  void Apply(InType* inData, OutType* outData) {
+    auto in = reinterpret_cast<Real*>(inData);
+    auto out = reinterpret_cast<Real*>(outData);
+    auto howMany = _in.HowMany();
+    for (auto b = 0; b < howMany; b += FixedBatchWidth) {
+      auto lanes = std::min(FixedBatchWidth, howMany - b);
+      auto x = _work.data();
+      auto y = x + _workSize;
+      for (auto p = 0; p < _inSize; p++) {
+        auto src = in + b * _inDist + _inOffsets[p];
+        auto dst = x + p * FixedBatchWidth;
+        for (auto l = 0; l < lanes; l++) dst[l] = src[l * _inDist];
+        for (auto l = lanes; l < FixedBatchWidth; l++) dst[l] = 0;
+      }
+      auto result = Transform(x, y);
+      for (auto p = 0; p < _outSize; p++) {
+        auto src = result + p * FixedBatchWidth;
+        auto dst = out + b * _outDist + _outOffsets[p];
+        for (auto l = 0; l < lanes; l++) dst[l * _outDist] = src[l];
+      }
+    }
+  }
+};
+
+// Returns a FixedPlan with the given compile-time dimensions. The remaining
+// arguments are as for the corresponding Ranges::Plan constructor.
+template <int... Ns, NumericConcepts::RealOrComplexWritableRange InView,
+          NumericConcepts::RealOrComplexWritableRange OutView,
+          typename... Args>
+auto MakeFixedPlan(View<InView> in, View<OutView> out, Args... args) {
+  return FixedPlan<InView, OutView, Ns...>(in, out, args...);
+}
+
+}  // namespace Ranges
+
+}  // namespace FFTWpp
+
+#endif  // FFTWPP_FIXED_GUARD_H
@@ -0,0 +1,263 @@
+#ifndef FFTWPP_FORK_GUARD_H
+#define FFTWPP_FORK_GUARD_H
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <pthread.h>
+#endif
+
+#include "Core.h"
+#include "Memory.h"
+#include "PlanCache.h"
+#include "ThreadPool.h"
+#include "Threads.h"
+#include "Trace.h"
+#include "WarmUp.h"
+#include "Wisdom.h"
+
+namespace FFTWpp {
+
+// True if processes can be forked with prepared plans, which requires
+// pthread_atfork.
+#if defined(__unix__) || defined(__APPLE__)
+constexpr bool HasForkPreparation = true;
+#else
+constexpr bool HasForkPreparation = false;
+#endif
+
+// A fixed set of arrays of equal size, allocated and touched up front and
+// then reused rather than allocated while serving. Arrays have the
+// alignment of FFTWpp::vector.
+class BufferPool {
+ public:
+  BufferPool() = default;
+
+  // Constructor given the size in bytes and number of the arrays.
+  BufferPool(std::size_t bytes, int count) : _bytes{bytes} {
+    assert(count >= 0);
+    for (auto i = 0; i < count; i++) {
+      _buffers.emplace_back(bytes, std::byte{0},
+                            Allocator<std::byte>("BufferPool"));
+      _free.push_back(count - 1 - i);
+    }
+  }
+
+  BufferPool(const BufferPool&) = delete;
+  BufferPool& operator=(const BufferPool&) = delete;
+
+  // Return the size in bytes of each array, and the number of arrays.
+  auto BufferBytes() const { return _bytes; }
+  auto Size() const { return static_cast<int>(_buffers.size()); }
+
+  // Return the number of arrays not in use.
+  int Available() {
+    auto lock = std::scoped_lock(_mutex);
+    return static_cast<int>(_free.size());
+  }
+
+  // Take an array for the given number of elements of type T, returning
+  // an empty span if none is free.
+  template <typename T>
+  std::span<T> Acquire(std::size_t count) {
+    assert(count * sizeof(T) <= _bytes);
+    auto lock = std::scoped_lock(_mutex);
+    if (_free.empty()) return {};
+    auto i = _free.back();
+    _free.pop_back();
+    return {reinterpret_cast<T*>(_buffers[i].data()), count};
+  }
+
+  // Return an array to the pool given its data.
+  void Release(const void* data) {
+    auto lock = std::scoped_lock(_mutex);
+    auto it = std::ranges::find(_buffers, data, [](const auto& buffer) {
+      return static_cast<const void*>(buffer.data());
+    });
+    assert(it != _buffers.end());
+    auto i = static_cast<int>(it - _buffers.begin());
+    assert(std::ranges::find(_free, i) == _free.end());
+    _free.push_back(i);
+  }
+
+  // Lock and unlock the pool, as around a fork.
+  void Lock() { _mutex.lock(); }
+  void Unlock() { _mutex.unlock(); }
+
+ private:
+  std::size_t _bytes = 0;
+  std::vector<vector<std::byte>> _buffers;
+  std::vector<int> _free;
+  std::mutex _mutex;
+};
+
+// Settings for a ForkPreparation.
+struct ForkOptions {
+  std::string wisdom{};    // Base name of wisdom files to import.
+  std::string manifest{};  // Warm-up manifest of the plans to make.
+  int executes = 3;      // Warm-up executes of each plan.
+  int threads = 1;       // Workers of the thread pool in each process.
+  std::size_t bufferBytes = 0;  // Size in bytes of each pooled array.
+  int buffers = 0;              // Number of pooled arrays.
+};
+
+#if defined(__unix__) || defined(__APPLE__)
+
+// Preparation of a process that forks workers after initialisation, so
+// that each worker starts with warm plans rather than re-planning. On
+// construction wisdom is imported, the plans of a warm-up manifest are made
+// into a cache and executed, and a pool of arrays is allocated. Forked
+// processes share the plans and their twiddle factors copy-on-write, as
+// executes do not write to them.
+//
+// Handlers registered with pthread_atfork hold the planner, the cache, the
+// array pool, the tracer and the plan memory records while the process is
+// copied, so that none of their locks is left held by a thread that does
+// not exist in the child. Other locks, such as those of user thread pools,
+// are not held. Only the forking thread is copied, so the child abandons
+// the old thread pool and, as the child handler may not allocate or start
+// threads, makes a new one with the same number of workers on the first
+// call of Cache or Pool, which must come before any execute in the child.
+// With the threaded fftw3 libraries, plans are made with that number of
+// threads, and their parallel loops are run on the pool rather than fftw3's
+// own threads, which would also be lost on a fork. This needs fftw3 3.3.9
+// or later. One preparation may exist at a time.
+class ForkPreparation {
+ public:
+  explicit ForkPreparation(const ForkOptions& options = {})
+      : _threads{std::max(options.threads, 1)},
+        _pool{std::make_unique<ThreadPool>(_threads)},
+        _buffers(options.bufferBytes, options.buffers) {
+    [[maybe_unused]] static const auto registered =
+        pthread_atfork(Prepare, Parent, Child) == 0;
+    assert(registered);
+    if constexpr (HasThreads) {
+      PlanWithThreads(_threads);
+      UseThreadPool(_pool.get());
+    }
+    if (!options.manifest.empty()) {
+      _report = WarmUp(options.manifest, _cache,
+                       WarmUpOptions{.wisdom = options.wisdom,
+                                     .executes = options.executes,
+                                     .pool = _pool.get()});
+    } else if (!options.wisdom.empty()) {
+      ImportWisdomFiles(options.wisdom);
+    }
+    [[maybe_unused]] auto previous = Current().exchange(this);
+    assert(previous == nullptr);
+  }
+
+  ForkPreparation(const ForkPreparation&) = delete;
+  ForkPreparation& operator=(const ForkPreparation&) = delete;
+
+  ~ForkPreparation() {
+    Current() = nullptr;
+    if constexpr (HasThreads) UseThreadPool(nullptr);
+  }
+
+  // Return the cache of prepared plans.
+  PlanCache& Cache() {
+    Pool();
+    return _cache;
+  }
+
+  // Return the pool of arrays.
+  BufferPool& Buffers() { return _buffers; }
+
+  // Return the thread pool of the calling process, making it in a child.
+  ThreadPool& Pool() {
+    auto lock = std::scoped_lock(_poolMutex);
+    if (!_pool) {
+      _pool = std::make_unique<ThreadPool>(_threads);
+      if constexpr (HasThreads) UseThreadPool(_pool.get());
+    }
+    return *_pool;
+  }
+
+  // Return the report of the warm-up.
+  const WarmUpReport& Report() const { return _report; }
+
+  // Returns true if every plan of the manifest is ready.
+  bool Ready() const { return _report.Ready(); }
+
+  // Returns true in a process forked after the preparation.
+  bool Forked() const { return _forked; }
+
+ private:
+  int _threads;
+  std::mutex _poolMutex;
+  std::unique_ptr<ThreadPool> _pool;
+  PlanCache _cache;
+  BufferPool _buffers;
+  WarmUpReport _report;
+  bool _forked = false;
+
+  static std::atomic<ForkPreparation*>& Current() {
+    static auto current = std::atomic<ForkPreparation*>{nullptr};
+    return current;
+  }
+
+  // The preparation held across the current fork.
+  static ForkPreparation*& Forking() {
+    static auto* forking = static_cast<ForkPreparation*>(nullptr);
+    return forking;
+  }
+
+  // Take the locks in the order used elsewhere: the pool is held while
+  // setting the planner's callback, the cache while planning, and the plan
+  // records and tracer while planning or executing. The allocation
+  // accounts take no lock.
+  static void Prepare() {
+    auto* current = Forking() = Current().load();
+    if (current) current->_poolMutex.lock();
+    if (current) current->_cache.Lock();
+    PlannerMutex().lock();
+    if (current) current->_buffers.Lock();
+    PlanMemory::Get().Mutex().lock();
+    Tracer::Get().Mutex().lock();
+  }
+
+  static void Parent() {
+    auto* current = Forking();
+    Tracer::Get().Mutex().unlock();
+    PlanMemory::Get().Mutex().unlock();
+    if (current) current->_buffers.Unlock();
+    PlannerMutex().unlock();
+    if (current) current->_cache.Unlock();
+    if (current) current->_poolMutex.unlock();
+  }
+
+  // The planner's recursive mutex records its owner by thread identifier,
+  // which differs in the child, so it is made afresh rather than unlocked.
+  // The workers of the old pool do not exist in the child, so the pool is
+  // released without being destroyed, which would wait for them, and the
+  // new pool is left for Pool to make.
+  static void Child() {
+    auto* current = Forking();
+    Tracer::Get().Mutex().unlock();
+    PlanMemory::Get().Mutex().unlock();
+    if (current) current->_buffers.Unlock();
+    new (&PlannerMutex()) std::recursive_mutex;
+    if (current) current->_cache.Unlock();
+    if (!current) return;
+    current->_forked = true;
+    static_cast<void>(current->_pool.release());
+    current->_poolMutex.unlock();
+  }
+};
+
+#endif  // defined(__unix__) || defined(__APPLE__)
+
+}  // namespace FFTWpp
+
+#endif  // FFTWPP_FORK_GUARD_H
@@ -0,0 +1,81 @@
+#ifndef FFTWPP_KEY_GUARD_H
+#define FFTWPP_KEY_GUARD_H
+
+#include <complex>
+#include <concepts>
+#include <initializer_list>
+#include <string>
+#include <vector>
+
+#include "NumericConcepts/Numeric.hpp"
+#include "Options.h"
+#include "Views.h"
+#include "fftw3.h"
+
+namespace FFTWpp {
+
+// Returns a short code for the scalar type.
+template <NumericConcepts::RealOrComplex T>
+std::string TypeCode() {
+  using Real = NumericConcepts::RemoveComplex<T>;
+  auto code = std::string(NumericConcepts::Complex<T> ? "c" : "r");
+  if constexpr (NumericConcepts::Float<Real>) code += "f";
+  if constexpr (NumericConcepts::Double<Real>) code += "d";
+  if constexpr (NumericConcepts::LongDouble<Real>) code += "l";
+  return code;
+}
+
+// Returns a string encoding the layout parameters.
+inline std::string LayoutCode(const Ranges::Layout& layout) {
+  auto join = [](auto values) {
+    auto code = std::string();
+    for (auto value : values) {
+      if (!code.empty()) code += "x";
+      code += std::to_string(value);
+    }
+    return code;
+  };
+  return std::to_string(layout.Rank()) + ":" + join(layout.N()) + ":" +
+         std::to_string(layout.HowMany()) + ":" + join(layout.Embed()) + ":" +
+         std::to_string(layout.Stride()) + ":" +
+         std::to_string(layout.Dist());
+}
+
+// Returns a key identifying transforms between the given types and layouts.
+// The options are the direction for C2C transforms and the kinds for R2R
+// transforms. Planning flags are not included.
+template <NumericConcepts::RealOrComplex InType,
+          NumericConcepts::RealOrComplex OutType>
+std::string PlanKey(const Ranges::Layout& in, const Ranges::Layout& out,
+                    const std::vector<int>& options = {}) {
+  auto key = TypeCode<InType>() + ">" + TypeCode<OutType>() + "|" +
+             LayoutCode(in) + "|" + LayoutCode(out);
+  for (auto option : options) key += "|" + std::to_string(option);
+  return key;
+}
+
+// Returns the options part of a plan key for the given plan arguments.
+inline std::vector<int> KeyOptions() { return {}; }
+
+inline std::vector<int> KeyOptions(Direction direction) {
+  return {static_cast<int>(direction)};
+}
+
+template <typename... RealKinds>
+requires(sizeof...(RealKinds) > 0) and
+        (std::same_as<RealKinds, RealKind> && ...)
+std::vector<int> KeyOptions(RealKinds... kinds) {
+  return {static_cast<int>(static_cast<fftw_r2r_kind>(kinds))...};
+}
+
+inline std::vector<int> KeyOptions(const std::vector<RealKind>& kinds) {
+  auto options = std::vector<int>();
+  for (auto kind : kinds) {
+    options.push_back(static_cast<int>(static_cast<fftw_r2r_kind>(kind)));
+  }
+  return options;
+}
+
+}  // namespace FFTWpp
+
+#endif  // FFTWPP_KEY_GUARD_H
@@ -0,0 +1,67 @@
+#ifndef FFTWPP_LAYOUTS_GUARD_H
+#define FFTWPP_LAYOUTS_GUARD_H
+
+#include <algorithm>
+#include <cassert>
+#include <concepts>
+#include <cstddef>
+#include <functional>
+#include <ranges>
+#include <vector>
+
+#include "Views.h"
+
+namespace FFTWpp {
+
+namespace Ranges {
+
+// Layout for transforms of each channel of channel-interleaved data, as
+// for multichannel audio. Element i of channel c is at i * channels + c.
+template <typename... Dimensions>
+requires(sizeof...(Dimensions) > 0) and (std::integral<Dimensions> && ...)
+Layout InterleavedLayout(int channels, Dimensions... dimensions) {
+  assert(channels > 0);
+  auto n = std::vector{static_cast<int>(dimensions)...};
+  return Layout(static_cast<int>(n.size()), n, channels, n, channels, 1);
+}
+
+// Layout for a transform of column-major data with the given dimensions,
+// as stored by Fortran. This is the row-major transform with the
+// dimensions reversed, and the output is also column-major. Note that for
+// R2C and C2R transforms the halved dimension is then the first given.
+template <typename... Dimensions>
+requires(sizeof...(Dimensions) > 0) and (std::integral<Dimensions> && ...)
+Layout ColumnMajorLayout(Dimensions... dimensions) {
+  auto n = std::vector{static_cast<int>(dimensions)...};
+  std::ranges::reverse(n);
+  return Layout(static_cast<int>(n.size()), n, 1, n, 1, 0);
+}
+
+// Layout for a transform of a block within a larger row-major array. The
+// view used with the layout should start at the first element of the
+// block, and need only extend to its last element.
+inline Layout SubBlockLayout(std::vector<int> block, std::vector<int> parent) {
+  assert(block.size() == parent.size());
+  assert(std::ranges::equal(block, parent, std::less_equal<>()));
+  return Layout(static_cast<int>(block.size()), block, 1, parent, 1, 0)
+      .Block();
+}
+
+// Offset of the block starting at the given indices within a row-major
+// array with the given dimensions.
+inline std::ptrdiff_t SubBlockOffset(std::vector<int> start,
+                                     std::vector<int> parent) {
+  assert(start.size() == parent.size());
+  auto offset = std::ptrdiff_t{0};
+  for (auto d = std::size_t{0}; d < parent.size(); d++) {
+    assert(start[d] >= 0 && start[d] < parent[d]);
+    offset = offset * parent[d] + start[d];
+  }
+  return offset;
+}
+
+}  // namespace Ranges
+
+}  // namespace FFTWpp
+
+#endif  // FFTWPP_LAYOUTS_GUARD_H
@@ -0,0 +1,265 @@
+#ifndef FFTWPP_MEMORY_GUARD_H
+#define FFTWPP_MEMORY_GUARD_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdio>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <typeinfo>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#endif
+
+#include "NumericConcepts/Numeric.hpp"
+
+namespace FFTWpp {
+
+// Live and peak bytes of a set of allocations.
+struct MemoryAccount {
+  std::size_t bytes = 0;        // Bytes currently allocated.
+  std::size_t peak = 0;         // Largest value of bytes.
+  std::size_t allocations = 0;  // Number of live allocations.
+};
+
+// Totals of the memory allocated through FFTWpp::Allocator, by element type
+// and by call-site tag.
+struct MemoryUsage {
+  MemoryAccount total;
+  std::map<std::string, MemoryAccount> types;
+  std::map<std::string, MemoryAccount> tags;
+};
+
+// Default tag of allocations made outside a ScopedMemoryTag.
+constexpr const char* UntaggedMemory = "untagged";
+
+// Name under which types and tags beyond the capacity of the record are
+// accounted.
+constexpr const char* OtherMemory = "other";
+
+namespace Memory {
+
+// Returns a readable name for an element type.
+template <typename T>
+std::string TypeName() {
+  if constexpr (NumericConcepts::RealOrComplex<T>) {
+    using Real = NumericConcepts::RemoveComplex<T>;
+    auto name = std::string();
+    if constexpr (NumericConcepts::Float<Real>) name = "float";
+    if constexpr (NumericConcepts::Double<Real>) name = "double";
+    if constexpr (NumericConcepts::LongDouble<Real>) name = "long double";
+    return NumericConcepts::Complex<T> ? "complex<" + name + ">" : name;
+  } else {
+    return typeid(T).name();
+  }
+}
+
+// Live and peak bytes of a set of allocations, updated without locking.
+struct AtomicAccount {
+  std::atomic<std::size_t> bytes = 0;
+  std::atomic<std::size_t> peak = 0;
+  std::atomic<std::size_t> allocations = 0;
+
+  void Add(std::size_t n) {
+    auto now = bytes.fetch_add(n, std::memory_order_relaxed) + n;
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    auto old = peak.load(std::memory_order_relaxed);
+    while (now > old &&
+           !peak.compare_exchange_weak(old, now, std::memory_order_relaxed)) {
+    }
+  }
+
+  void Remove(std::size_t n) {
+    bytes.fetch_sub(n, std::memory_order_relaxed);
+    allocations.fetch_sub(1, std::memory_order_relaxed);
+  }
+
+  MemoryAccount Load() const {
+    return MemoryAccount{bytes.load(std::memory_order_relaxed),
+                         peak.load(std::memory_order_relaxed),
+                         allocations.load(std::memory_order_relaxed)};
+  }
+};
+
+// Accounts keyed by the address of a name, in a fixed open-addressed table
+// whose slots are claimed with a compare-and-swap. Names beyond the
+// capacity share a single account.
+class AccountTable {
+ public:
+  static constexpr std::size_t Capacity = 256;
+
+  AtomicAccount& Find(const char* name) {
+    auto start = std::hash<const void*>()(name) % Capacity;
+    for (auto i = std::size_t{0}; i < Capacity; i++) {
+      auto slot = (start + i) % Capacity;
+      auto key = _keys[slot].load(std::memory_order_acquire);
+      if (key == nullptr &&
+          _keys[slot].compare_exchange_strong(key, name,
+                                              std::memory_order_acq_rel)) {
+        return _accounts[slot];
+      }
+      if (key == name) return _accounts[slot];
+    }
+    return _other;
+  }
+
+  // Return the accounts by name, merging those of equal names.
+  std::map<std::string, MemoryAccount> Load() const {
+    auto accounts = std::map<std::string, MemoryAccount>();
+    auto merge = [&](const char* name, const AtomicAccount& atomic) {
+      auto account = atomic.Load();
+      auto& merged = accounts[name];
+      merged.bytes += account.bytes;
+      merged.peak += account.peak;
+      merged.allocations += account.allocations;
+    };
+    for (auto slot = std::size_t{0}; slot < Capacity; slot++) {
+      auto key = _keys[slot].load(std::memory_order_acquire);
+      if (key != nullptr) merge(key, _accounts[slot]);
+    }
+    if (_other.allocations.load(std::memory_order_relaxed) > 0 ||
+        _other.peak.load(std::memory_order_relaxed) > 0) {
+      merge(OtherMemory, _other);
+    }
+    return accounts;
+  }
+
+ private:
+  std::array<std::atomic<const char*>, Capacity> _keys{};
+  std::array<AtomicAccount, Capacity> _accounts;
+  AtomicAccount _other;
+};
+
+// Process-wide record of allocations, kept with atomic counters so that
+// allocating takes no lock. Types and tags are identified by the address
+// of their names, which must outlive the record, as string literals do.
+// Equal names at different addresses are merged when read, with their
+// peaks summed. It is never destroyed so that arrays freed during static
+// destruction can still be recorded.
+class Accounts {
+ public:
+  static Accounts& Get() {
+    static auto* accounts = new Accounts;
+    return *accounts;
+  }
+
+  void Allocate(const char* type, const char* tag, std::size_t bytes) {
+    _total.Add(bytes);
+    _types.Find(type).Add(bytes);
+    _tags.Find(tag).Add(bytes);
+  }
+
+  void Deallocate(const char* type, const char* tag, std::size_t bytes) {
+    _total.Remove(bytes);
+    _types.Find(type).Remove(bytes);
+    _tags.Find(tag).Remove(bytes);
+  }
+
+  MemoryUsage Usage() const {
+    return MemoryUsage{_total.Load(), _types.Load(), _tags.Load()};
+  }
+
+ private:
+  AtomicAccount _total;
+  AccountTable _types;
+  AccountTable _tags;
+};
+
+// Tag given to allocators constructed on the calling thread.
+inline const char*& CurrentTag() {
+  thread_local const char* tag = UntaggedMemory;
+  return tag;
+}
+
+}  // namespace Memory
+
+// Tags allocators constructed on the calling thread during the lifetime of
+// the object, so that the arrays they allocate are attributed to a call
+// site. The tag must outlive the arrays, as with a string literal.
+class ScopedMemoryTag {
+ public:
+  explicit ScopedMemoryTag(const char* tag)
+      : _previous{Memory::CurrentTag()} {
+    Memory::CurrentTag() = tag;
+  }
+
+  ScopedMemoryTag(const ScopedMemoryTag&) = delete;
+  ScopedMemoryTag& operator=(const ScopedMemoryTag&) = delete;
+
+  ~ScopedMemoryTag() { Memory::CurrentTag() = _previous; }
+
+ private:
+  const char* _previous;
+};
+
+// Returns the memory allocated through FFTWpp::Allocator.
+inline MemoryUsage AllocatorMemory() { return Memory::Accounts::Get().Usage(); }
+
+// Returns the resident memory of the process in bytes, or zero if this
+// cannot be determined.
+inline std::size_t ResidentBytes() {
+#if defined(__linux__)
+  auto file = std::fopen("/proc/self/statm", "r");
+  if (!file) return 0;
+  auto size = 0ul;
+  auto resident = 0ul;
+  auto read = std::fscanf(file, "%lu %lu", &size, &resident);
+  std::fclose(file);
+  if (read != 2) return 0;
+  return resident * static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+#else
+  return 0;
+#endif
+}
+
+// Resident memory attributed to each plan key at the plan's creation. Only
+// plans made through a PlanCache are recorded, as other plans have no key;
+// their twiddle factors show only in the process's resident memory.
+class PlanMemory {
+ public:
+  static PlanMemory& Get() {
+    static auto* memory = new PlanMemory;
+    return *memory;
+  }
+
+  // Record the resident bytes gained in making a plan.
+  void Record(const std::string& key, std::size_t bytes) {
+    auto lock = std::scoped_lock(_mutex);
+    _bytes[key] = bytes;
+  }
+
+  // Remove the record of a plan key.
+  void Erase(const std::string& key) {
+    auto lock = std::scoped_lock(_mutex);
+    _bytes.erase(key);
+  }
+
+  // Return the recorded bytes of each plan key.
+  std::map<std::string, std::size_t> Bytes() {
+    auto lock = std::scoped_lock(_mutex);
+    return _bytes;
+  }
+
+  // Return the recorded bytes summed over all plan keys.
+  std::size_t Total() {
+    auto lock = std::scoped_lock(_mutex);
+    auto total = std::size_t{0};
+    for (const auto& [key, bytes] : _bytes) total += bytes;
+    return total;
+  }
+
+  // Mutex guarding the records, which is held across a fork.
+  std::mutex& Mutex() { return _mutex; }
+
+ private:
+  std::mutex _mutex;
+  std::map<std::string, std::size_t> _bytes;
+};
+
+}  // namespace FFTWpp
+
+#endif  // FFTWPP_MEMORY_GUARD_H
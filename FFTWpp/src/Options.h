@@ -39,7 +39,7 @@ class Flag {
   unsigned _flag;
 };
 
-constexpr auto operator|(Flag&& lhs, Flag&& rhs) {
+constexpr auto operator|(Flag lhs, Flag rhs) {
   return Flag{static_cast<unsigned>(lhs) | static_cast<unsigned>(rhs)};
 }
 
@@ -0,0 +1,360 @@
+#ifndef FFTWPP_PIPELINE_GUARD_H
+#define FFTWPP_PIPELINE_GUARD_H
+
+#include <algorithm>
+#include <cassert>
+#include <complex>
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <ranges>
+#include <span>
+#include <vector>
+
+#include "Core.h"
+#include "NumericConcepts/Numeric.hpp"
+#include "Options.h"
+#include "Plan.h"
+#include "Views.h"
+
+namespace FFTWpp {
+
+namespace Ranges {
+
+// Returns the number of elements of storage needed for a layout.
+inline std::size_t StorageSize(const Layout& layout) {
+  return static_cast<std::size_t>(
+      std::max<std::ptrdiff_t>(layout.size(), layout.Extent()));
+}
+
+// Returns true if a transform between the layouts can be done in-place.
+// For R2C and C2R transforms the real data must be padded so that each of
+// its rows occupies the storage of a complex row.
+template <NumericConcepts::RealOrComplex InType,
+          NumericConcepts::RealOrComplex OutType>
+bool CanShareStorage(const Layout& in, const Layout& out) {
+  if constexpr (std::same_as<InType, OutType>) {
+    return in == out;
+  } else if constexpr (NumericConcepts::Real<InType> ==
+                       NumericConcepts::Real<OutType>) {
+    return false;
+  } else {
+    const auto& real = NumericConcepts::Real<InType> ? in : out;
+    const auto& complex = NumericConcepts::Real<InType> ? out : in;
+    auto realEmbed = std::vector(real.Embed().begin(), real.Embed().end());
+    auto complexEmbed =
+        std::vector(complex.Embed().begin(), complex.Embed().end());
+    realEmbed.back() /= 2;
+    return real.Stride() == 1 && complex.Stride() == 1 &&
+           real.Embed().back() % 2 == 0 && realEmbed == complexEmbed &&
+           real.Dist() == 2 * complex.Dist();
+  }
+}
+
+// A chain of transforms and pointwise stages sharing a minimal set of
+// buffers. Values are declared as inputs or as the results of stages, and
+// once the pipeline is built each value is assigned a buffer that is free
+// over its lifetime, from the stage producing it to the last stage using
+// it. A stage whose input is not used afterwards is done in-place where
+// possible, and otherwise planned with its input marked consumable. Values
+// marked as outputs are kept to the end. Only inputs and outputs may be
+// accessed, and an input that is not also an output may be overwritten on
+// execution.
+template <NumericConcepts::Real Real>
+class Pipeline {
+  using Complex = std::complex<Real>;
+
+ public:
+  // Identifier of a value within the pipeline.
+  using Value = int;
+
+  // Constructor given the flag used in planning the transforms.
+  explicit Pipeline(Flag flag = Measure) : _flag{flag} {}
+
+  Pipeline(const Pipeline&) = delete;
+  Pipeline& operator=(const Pipeline&) = delete;
+
+  // Declare an input with the given type and layout.
+  template <NumericConcepts::RealOrComplex T>
+  requires NumericConcepts::SamePrecision<T, Real>
+  Value Input(Layout layout) {
+    assert(!Built());
+    return AddValue<T>(layout, -1);
+  }
+
+  // Add a transform of a value to the given type and layout, with any
+  // direction or kinds, returning the transformed value.
+  template <NumericConcepts::RealOrComplex OutType,
+            NumericConcepts::RealOrComplex InType, typename... Args>
+  requires NumericConcepts::SamePrecision<InType, OutType>
+  Value Transform(Value in, Layout out, Args... args) {
+    assert(!Built() && CheckValue<InType>(in));
+    auto inLayout = _values[in].layout;
+    auto stage = Stage{.in = in};
+    stage.inPlace = CanShareStorage<InType, OutType>(inLayout, out);
+    stage.make = [inLayout, out, args...](void* inData, void* outData,
+                                          Flag flag, Ownership ownership) {
+      using PlanType = Plan<std::span<InType>, std::span<OutType>>;
+      auto inView = View(
+          std::span(static_cast<InType*>(inData), StorageSize(inLayout)),
+          inLayout);
+      if (ownership == Ownership::Consumable) inView = inView.Consumable();
+      if (ownership == Ownership::Preserved) inView = inView.Preserved();
+      auto outView = std::span(static_cast<OutType*>(outData),
+                               StorageSize(out));
+      auto plan = std::make_shared<PlanType>(inView, View(outView, out), flag,
+                                             args...);
+      return std::function<void()>([plan]() { plan->Execute(); });
+    };
+    stage.out = AddValue<OutType>(out, static_cast<int>(_stages.size()));
+    return AddStage(std::move(stage));
+  }
+
+  // Add a pointwise stage, returning the value given by applying the
+  // function to the storage of a value.
+  template <NumericConcepts::RealOrComplex T>
+  requires NumericConcepts::SamePrecision<T, Real>
+  Value Pointwise(Value value, std::function<void(std::span<T>)> f) {
+    assert(!Built() && CheckValue<T>(value));
+    auto size = StorageSize(_values[value].layout);
+    auto stage = Stage{.in = value, .inPlace = true};
+    stage.apply = [f, size](void* data, const void*) {
+      f(std::span(static_cast<T*>(data), size));
+    };
+    stage.out = AddValue<T>(_values[value].layout,
+                            static_cast<int>(_stages.size()));
+    return AddStage(std::move(stage));
+  }
+
+  // Add a pointwise stage that also reads a second value, such as a
+  // transformed filter to be multiplied with a spectrum.
+  template <NumericConcepts::RealOrComplex T, NumericConcepts::RealOrComplex U>
+  requires NumericConcepts::SamePrecision<T, Real> &&
+           NumericConcepts::SamePrecision<U, Real>
+  Value Pointwise(Value value, Value other,
+                  std::function<void(std::span<T>, std::span<const U>)> f) {
+    assert(!Built() && CheckValue<T>(value) && CheckValue<U>(other));
+    assert(value != other);
+    auto size = StorageSize(_values[value].layout);
+    auto otherSize = StorageSize(_values[other].layout);
+    auto stage = Stage{.in = value, .other = other, .inPlace = true};
+    stage.apply = [f, size, otherSize](void* data, const void* otherData) {
+      f(std::span(static_cast<T*>(data), size),
+        std::span(static_cast<const U*>(otherData), otherSize));
+    };
+    stage.out = AddValue<T>(_values[value].layout,
+                            static_cast<int>(_stages.size()));
+    return AddStage(std::move(stage));
+  }
+
+  // Mark a value as an output, keeping it to the end of the pipeline.
+  void Output(Value value) {
+    assert(!Built() && value >= 0 && value < Values());
+    _values[value].output = true;
+  }
+
+  // Assign buffers and plan the transforms. Planning with flags other than
+  // Estimate overwrites the buffers, so inputs should be set afterwards.
+  void Build() {
+    assert(!Built());
+    Lifetimes();
+    Assign();
+    for (auto& buffer : _buffers) {
+      _storage.emplace_back((buffer + sizeof(Complex) - 1) / sizeof(Complex));
+    }
+    for (auto& stage : _stages) {
+      auto in = Data(_values[stage.in]);
+      auto out = Data(_values[stage.out]);
+      if (stage.make) {
+        // Inputs used later are marked preserved, so that they are copied
+        // where the transform would otherwise overwrite them.
+        auto ownership = Ownership::Unspecified;
+        if (in != out) {
+          ownership = _values[stage.in].lastUse == Index(stage)
+                          ? Ownership::Consumable
+                          : Ownership::Preserved;
+        }
+        stage.run = stage.make(in, out, _flag, ownership);
+      } else {
+        auto bytes = StorageSize(_values[stage.in].layout) *
+                     _values[stage.in].elementSize;
+        auto other = stage.other >= 0 ? Data(_values[stage.other]) : nullptr;
+        stage.run = [apply = stage.apply, in, out, other, bytes]() {
+          if (in != out) std::memcpy(out, in, bytes);
+          apply(out, other);
+        };
+      }
+    }
+  }
+
+  // Returns true if the pipeline has been built.
+  bool Built() const { return !_storage.empty(); }
+
+  // Return the storage of an input or output value.
+  template <NumericConcepts::RealOrComplex T>
+  requires NumericConcepts::SamePrecision<T, Real>
+  std::span<T> Data(Value value) {
+    assert(Built() && CheckValue<T>(value));
+    assert(_values[value].definedBy < 0 || _values[value].output);
+    return std::span(static_cast<T*>(Data(_values[value])),
+                     StorageSize(_values[value].layout));
+  }
+
+  // Execute the stages in turn.
+  void Execute() {
+    assert(Built());
+    for (auto& stage : _stages) stage.run();
+  }
+
+  // Return the numbers of values, stages and buffers.
+  int Values() const { return static_cast<int>(_values.size()); }
+  int Stages() const { return static_cast<int>(_stages.size()); }
+  int Buffers() const { return static_cast<int>(_buffers.size()); }
+
+  // Return the index of the buffer assigned to a value.
+  int Buffer(Value value) const {
+    assert(Built());
+    return _values[value].buffer;
+  }
+
+  // Returns true if the stage producing a value was done in-place.
+  bool InPlace(Value value) const {
+    assert(Built() && _values[value].definedBy >= 0);
+    const auto& stage = _stages[_values[value].definedBy];
+    return _values[value].buffer == _values[stage.in].buffer;
+  }
+
+  // Return the bytes of the shared buffers, and those needed were each
+  // value given its own array.
+  std::size_t Bytes() const {
+    return std::ranges::fold_left(_buffers, std::size_t{0}, std::plus<>());
+  }
+
+  std::size_t SeparateBytes() const {
+    auto bytes = std::size_t{0};
+    for (const auto& value : _values) bytes += Bytes(value);
+    return bytes;
+  }
+
+ private:
+  struct ValueInfo {
+    Layout layout;
+    bool complex;
+    std::size_t elementSize;
+    int definedBy;     // Index of the producing stage, or -1 for inputs.
+    int lastUse = -1;  // Index of the last stage using the value.
+    bool output = false;
+    int buffer = -1;
+  };
+
+  struct Stage {
+    Value in = -1;
+    Value other = -1;
+    Value out = -1;
+    bool inPlace = false;  // True if the stage can be done in-place.
+    std::function<std::function<void()>(void*, void*, Flag, Ownership)>
+        make = {};
+    std::function<void(void*, const void*)> apply = {};
+    std::function<void()> run = {};
+  };
+
+  Flag _flag;
+  std::vector<ValueInfo> _values;
+  std::vector<Stage> _stages;
+  std::vector<std::size_t> _buffers;  // Bytes of each buffer.
+  std::vector<vector<Complex>> _storage;
+
+  template <NumericConcepts::RealOrComplex T>
+  Value AddValue(Layout layout, int definedBy) {
+    _values.push_back(ValueInfo{layout, NumericConcepts::Complex<T>,
+                                sizeof(T), definedBy});
+    return Values() - 1;
+  }
+
+  Value AddStage(Stage stage) {
+    auto out = stage.out;
+    _stages.push_back(std::move(stage));
+    return out;
+  }
+
+  template <NumericConcepts::RealOrComplex T>
+  bool CheckValue(Value value) const {
+    return value >= 0 && value < Values() &&
+           _values[value].complex == NumericConcepts::Complex<T>;
+  }
+
+  int Index(const Stage& stage) const {
+    return static_cast<int>(&stage - _stages.data());
+  }
+
+  static std::size_t Bytes(const ValueInfo& value) {
+    return StorageSize(value.layout) * value.elementSize;
+  }
+
+  void* Data(const ValueInfo& value) {
+    return _storage[value.buffer].data();
+  }
+
+  // Set the last stage using each value, with outputs kept to the end.
+  void Lifetimes() {
+    for (auto& stage : _stages) {
+      _values[stage.in].lastUse = Index(stage);
+      if (stage.other >= 0) _values[stage.other].lastUse = Index(stage);
+    }
+    for (auto& value : _values) {
+      if (value.output) value.lastUse = std::numeric_limits<int>::max();
+    }
+  }
+
+  // Assign buffers in stage order. The output of a stage takes over the
+  // buffer of its input if the input is not used later and the stage can
+  // be done in-place, and otherwise takes a free buffer, preferring the
+  // smallest large enough. Buffers are released after the last use of
+  // their values. As lifetimes are intervals this uses the fewest buffers.
+  void Assign() {
+    auto free = std::vector<int>();
+    auto take = [&](ValueInfo& value) {
+      auto bytes = Bytes(value);
+      auto fits = [&](int buffer) { return _buffers[buffer] >= bytes; };
+      auto best = std::ranges::min_element(free, [&](int a, int b) {
+        if (fits(a) != fits(b)) return fits(a);
+        return fits(a) ? _buffers[a] < _buffers[b] : _buffers[a] > _buffers[b];
+      });
+      if (best == free.end()) {
+        value.buffer = Buffers();
+        _buffers.push_back(bytes);
+      } else {
+        value.buffer = *best;
+        _buffers[*best] = std::max(_buffers[*best], bytes);
+        free.erase(best);
+      }
+    };
+    for (auto& value : _values) {
+      if (value.definedBy < 0) take(value);
+    }
+    for (auto& stage : _stages) {
+      auto index = Index(stage);
+      auto& in = _values[stage.in];
+      auto& out = _values[stage.out];
+      if (stage.inPlace && in.lastUse == index) {
+        out.buffer = in.buffer;
+        _buffers[out.buffer] = std::max(_buffers[out.buffer], Bytes(out));
+      } else {
+        take(out);
+        if (in.lastUse == index) free.push_back(in.buffer);
+      }
+      if (stage.other >= 0 && _values[stage.other].lastUse == index) {
+        free.push_back(_values[stage.other].buffer);
+      }
+      if (out.lastUse < 0) free.push_back(out.buffer);
+    }
+  }
+};
+
+}  // namespace Ranges
+
+}  // namespace FFTWpp
+
+#endif  // FFTWPP_PIPELINE_GUARD_H
@@ -3,15 +3,23 @@
 
 #include <algorithm>
 #include <cassert>
+#include <atomic>
 #include <complex>
 #include <initializer_list>
+#include <mutex>
 #include <ranges>
+#include <span>
+#include <utility>
 #include <variant>
 
 #include "Core.h"
+#include "Denormals.h"
+#include "Key.h"
 #include "NumericConcepts/Numeric.hpp"
 #include "NumericConcepts/Ranges.hpp"
 #include "Options.h"
+#include "ThreadPool.h"
+#include "Trace.h"
 #include "Views.h"
 #include "fftw3.h"
 
@@ -19,6 +27,18 @@ namespace FFTWpp {
 
 namespace Ranges {
 
+// Return the calling thread's scratch array of the given type, with at
+// least the given size. Arrays are pooled by thread and type and grow as
+// needed, so that they are only allocated on first use.
+template <NumericConcepts::RealOrComplex T>
+T* ScratchArray(std::size_t size) {
+  thread_local auto scratch = vector<T>(Allocator<T>("PlanScratch"));
+  if (scratch.size() < size) {
+    scratch = vector<T>(size, Allocator<T>("PlanScratch"));
+  }
+  return scratch.data();
+}
+
 template <NumericConcepts::RealOrComplexWritableRange InView,
           NumericConcepts::RealOrComplexWritableRange OutView>
 requires NumericConcepts::SameRangePrecision<InView, OutView>
@@ -27,6 +47,10 @@ class Plan {
   using InType = std::ranges::range_value_t<InView>;
   using OutType = std::ranges::range_value_t<OutView>;
   using Real = NumericConcepts::RemoveComplex<InType>;
+  using PlanPointer = std::conditional_t<
+      NumericConcepts::Float<Real>, fftwf_plan,
+      std::conditional_t<NumericConcepts::Double<Real>, fftw_plan,
+                         fftwl_plan>>;
 
  public:
   // Remove default constructor;
@@ -57,14 +81,19 @@ class Plan {
   requires(sizeof...(RealKinds) > 0) and
               (std::same_as<RealKinds, RealKind> && ...)
   Plan(View<InView> in, View<OutView> out, Flag flag, RealKinds... kinds)
-      : _in{in},
-        _out{out},
-        _flag{flag},
-        _kinds{std::vector<RealKind>{kinds...}} {
-    assert(Kinds().size() <= _in.Rank());
-    if (Kinds().size() < _in.Rank()) {
+      : Plan(in, out, flag, std::vector<RealKind>{kinds...}) {}
+
+  // Constructor for R2R with the kinds given at run time.
+  Plan(View<InView> in, View<OutView> out, Flag flag,
+       std::vector<RealKind> kinds)
+  requires NumericConcepts::Real<InType> and NumericConcepts::Real<OutType>
+      : _in{in}, _out{out}, _flag{flag}, _kinds{kinds} {
+    assert(!kinds.empty());
+    auto rank = static_cast<std::size_t>(_in.Rank());
+    assert(Kinds().size() <= rank);
+    if (Kinds().size() < rank) {
       auto kinds = std::get<std::vector<RealKind>>(_kinds);
-      while (kinds.size() < _in.Rank()) {
+      while (kinds.size() < rank) {
         kinds.push_back(kinds.back());
       }
       _kinds = kinds;
@@ -79,9 +108,12 @@ class Plan {
         _out{other._out},
         _flag{other._flag},
         _direction{other._direction},
-        _kinds{other._kinds} {
+        _kinds{other._kinds},
+        _flushDenormals{other._flushDenormals},
+        _sampling{other._sampling} {
     auto flag = _flag == Estimate ? Estimate : WisdomOnly;
     MakePlan(flag);
+    if (other._unaligned.load() != nullptr) PrepareUnaligned();
   }
 
   // Move constructor.
@@ -90,34 +122,49 @@ class Plan {
         _out{std::move(other._out)},
         _flag{std::move(other._flag)},
         _direction{std::move(other._direction)},
-        _kinds{std::move(other._kinds)} {
+        _kinds{std::move(other._kinds)},
+        _flushDenormals{other._flushDenormals},
+        _sampling{other._sampling} {
+    auto prepared = other._unaligned.load() != nullptr;
     other.Destroy();
     auto flag = _flag == Estimate ? Estimate : WisdomOnly;
     MakePlan(flag);
+    if (prepared) PrepareUnaligned();
   }
 
   // Copy assignment.
   auto& operator=(const Plan& other) {
+    if (this == &other) return *this;
+    Destroy();
     _in = other._in;
     _out = other._out;
     _flag = other._flag;
     _direction = other._direction;
     _kinds = other._kinds;
+    _flushDenormals = other._flushDenormals;
+    _sampling = other._sampling;
     auto flag = _flag == Estimate ? Estimate : WisdomOnly;
     MakePlan(flag);
+    if (other._unaligned.load() != nullptr) PrepareUnaligned();
     return *this;
   }
 
   // Move assignment.
   auto& operator=(Plan&& other) {
+    if (this == &other) return *this;
+    auto prepared = other._unaligned.load() != nullptr;
+    Destroy();
     other.Destroy();
     _in = std::move(other._in);
     _out = std::move(other._out);
     _flag = std::move(other._flag);
     _direction = std::move(other._direction);
     _kinds = std::move(other._kinds);
+    _flushDenormals = other._flushDenormals;
+    _sampling = other._sampling;
     auto flag = _flag == Estimate ? Estimate : WisdomOnly;
     MakePlan(flag);
+    if (prepared) PrepareUnaligned();
     return *this;
   }
 
@@ -149,6 +196,30 @@ class Plan {
     }
   }
 
+  // Return pointers to the input and output arrays.
+  auto InData() { return _in.DataPointer(); }
+  auto OutData() { return _out.DataPointer(); }
+
+  // Return the layouts of the input and output arrays.
+  const Layout& InLayout() const { return _in; }
+  const Layout& OutLayout() const { return _out; }
+
+  // Return a key identifying the transform, excluding the planning flag.
+  auto Key() const {
+    auto options = std::vector<int>();
+    if constexpr (NumericConcepts::Complex<InType> &&
+                  NumericConcepts::Complex<OutType>) {
+      options.push_back(std::get<Direction>(_direction));
+    }
+    if constexpr (NumericConcepts::Real<InType> &&
+                  NumericConcepts::Real<OutType>) {
+      for (auto kind : Kinds()) {
+        options.push_back(static_cast<fftw_r2r_kind>(kind));
+      }
+    }
+    return PlanKey<InType, OutType>(_in, _out, options);
+  }
+
   // Returns true is plan is not set up.
   auto IsNull() { return Pointer() == nullptr; }
 
@@ -169,8 +240,54 @@ class Plan {
     return static_cast<OutType>(1) / static_cast<OutType>(dim);
   }
 
+  // Returns the floating-point operations of an execute counted by fftw3,
+  // with each fused multiply-add counted as two operations.
+  double Flops() const {
+    auto [add, mul, fma] = FFTWpp::Flops(Pointer());
+    return add + mul + 2 * fma;
+  }
+
+  // Make the plan used by new-array executes on arrays whose alignment
+  // differs from that of the arrays used in planning. It is otherwise made
+  // by the first such execute, so this is needed only where executes must
+  // not plan, as in real-time use.
+  void PrepareUnaligned() { UnalignedPointer(); }
+
+  // Returns the number of new-array executes that used the unaligned plan.
+  auto Fallbacks() const { return _fallbacks.load(); }
+
+  // Returns true if the input is copied to a scratch array on each execute
+  // so that it is preserved.
+  auto CopiesInput() const { return _copyInput; }
+
+  // Set whether subnormal values are flushed to zero during executes, on
+  // the calling thread and on any thread pool workers used. The previous
+  // floating-point state is restored afterwards. This avoids the large
+  // slowdowns of arithmetic on subnormals, but has no effect on long double
+  // transforms using x87 arithmetic.
+  void SetFlushDenormals(bool flush) { _flushDenormals = flush; }
+
+  // Set the sampling of outputs for subnormal values. After each execute,
+  // every given number of output elements is checked, with zero disabling
+  // the checks.
+  void SetSubnormalSampling(int every) {
+    assert(every >= 0);
+    _sampling = every;
+  }
+
+  // Return the number of sampled output values that were subnormal, and
+  // the number of values sampled.
+  auto SubnormalCount() const { return _subnormals.load(); }
+  auto SampleCount() const { return _samples.load(); }
+
   // Execute the plan.
-  void Execute() { FFTWpp::Execute(Pointer()); }
+  void Execute() {
+    auto trace = ScopedTrace("Execute", "execute");
+    auto state = ScopedDenormalState(_flushDenormals);
+    if (_copyInput) return ExecuteAny(_in.DataPointer(), _out.DataPointer());
+    FFTWpp::Execute(Pointer());
+    Sample(_out.DataPointer());
+  }
 
   // Execute using new data.
   template <NumericConcepts::RealOrComplexWritableRange NewInView,
@@ -178,7 +295,49 @@ class Plan {
   requires NumericConcepts::SameRangeValueType<InView, NewInView> &&
            NumericConcepts::SameRangeValueType<OutView, NewOutView>
   void Execute(NewInView in, NewOutView out) {
-    FFTWpp::Execute(Pointer(), in.data(), out.data());
+    auto trace = ScopedTrace("Execute", "execute");
+    auto state = ScopedDenormalState(_flushDenormals);
+    ExecuteAny(in.data(), out.data());
+  }
+
+  // Execute using each of a batch of (in, out) pointer pairs, all of which
+  // must have the same layout as the views used in planning. The input of
+  // the next pair is prefetched while the current one is transformed. If a
+  // thread pool is given, the pairs are split into contiguous chunks, one
+  // for each worker and the caller, so that each prefetches only the pairs
+  // it will transform itself. The alignment of the pairs is checked once
+  // before any is transformed: the stored plan is used if all are aligned
+  // as in planning, and otherwise the unaligned plan is used for them all.
+  // Called from a worker of the given pool, the pairs are transformed in
+  // turn on that worker.
+  void Execute(std::span<const std::pair<InType*, OutType*>> pairs,
+               ThreadPool* pool = nullptr) {
+    auto state = ScopedDenormalState(_flushDenormals);
+    auto count = static_cast<int>(pairs.size());
+    auto bytes = std::min(_in.Layout::size() * sizeof(InType), PrefetchBytes);
+    auto trace = ScopedTrace("ExecuteBatch", "execute");
+    auto misaligned = std::ranges::count_if(pairs, [this](const auto& pair) {
+      return !Aligned(pair.first, pair.second);
+    });
+    _fallbacks += misaligned;
+    auto plan = misaligned == 0 ? Pointer() : UnalignedPointer();
+    auto execute = [&](int first, int last) {
+      for (auto i = first; i < last; i++) {
+        auto trace = ScopedTrace("Execute", "execute");
+        if (i + 1 < last) Prefetch(pairs[i + 1].first, bytes);
+        ExecuteWith(plan, pairs[i].first, pairs[i].second);
+      }
+    };
+    if (pool && count > 1) {
+      auto caller = DenormalState();
+      auto chunks = std::min(count, pool->Size() + 1);
+      pool->ParallelFor(chunks, [&](int chunk) {
+        auto state = ScopedDenormalState(caller);
+        execute(chunk * count / chunks, (chunk + 1) * count / chunks);
+      });
+    } else {
+      execute(0, count);
+    }
   }
 
  private:
@@ -189,6 +348,24 @@ class Plan {
   std::variant<std::monostate, std::vector<RealKind>> _kinds;
   std::variant<fftwf_plan, fftw_plan, fftwl_plan> _plan;
 
+  // New-array execution requires arrays with the alignment of those used in
+  // planning. For other arrays a plan with the Unaligned flag is made on
+  // first use or by PrepareUnaligned, and the number of executes needing it
+  // is counted.
+  int _inAlignment = 0;
+  int _outAlignment = 0;
+  std::atomic<PlanPointer> _unaligned = nullptr;
+  std::atomic<long> _fallbacks = 0;
+
+  // True if the input is copied to a scratch array that the plan destroys.
+  bool _copyInput = false;
+
+  // Handling of subnormal values.
+  bool _flushDenormals = false;
+  int _sampling = 0;
+  std::atomic<long> _subnormals = 0;
+  std::atomic<long> _samples = 0;
+
   auto CheckInputs() const {
     if (_in.Rank() != _out.Rank()) return false;
     if (_in.HowMany() != _out.HowMany()) return false;
@@ -215,38 +392,183 @@ class Plan {
     }
   }
 
-  void MakePlan(Flag flag) {
+  // Return a new fftw3 plan for the given flag and arrays, which must
+  // have the layouts of the stored views.
+  PlanPointer NewPlan(Flag flag, InType* in, OutType* out) {
+    auto lock = std::scoped_lock(PlannerMutex());
     if constexpr (NumericConcepts::Complex<InType> &&
                   NumericConcepts::Complex<OutType>) {
-      _plan = FFTWpp::Plan(_in.Rank(), _in.NPointer(), _in.HowMany(),
-                           _in.DataPointer(), _in.EmbedPointer(), _in.Stride(),
-                           _in.Dist(), _out.DataPointer(), _out.EmbedPointer(),
-                           _out.Stride(), _out.Dist(),
-                           std::get<Direction>(_direction), flag);
+      return FFTWpp::Plan(_in.Rank(), _in.NPointer(), _in.HowMany(), in,
+                          _in.EmbedPointer(), _in.Stride(), _in.Dist(), out,
+                          _out.EmbedPointer(), _out.Stride(), _out.Dist(),
+                          std::get<Direction>(_direction), flag);
     } else if constexpr ((NumericConcepts::Complex<InType> &&
                           NumericConcepts::Real<OutType>)) {
-      _plan = FFTWpp::Plan(_out.Rank(), _out.NPointer(), _out.HowMany(),
-                           _in.DataPointer(), _in.EmbedPointer(), _in.Stride(),
-                           _in.Dist(), _out.DataPointer(), _out.EmbedPointer(),
-                           _out.Stride(), _out.Dist(), flag);
+      return FFTWpp::Plan(_out.Rank(), _out.NPointer(), _out.HowMany(), in,
+                          _in.EmbedPointer(), _in.Stride(), _in.Dist(), out,
+                          _out.EmbedPointer(), _out.Stride(), _out.Dist(),
+                          flag);
     } else if constexpr ((NumericConcepts::Real<InType> &&
                           NumericConcepts::Complex<OutType>)) {
-      _plan = FFTWpp::Plan(_in.Rank(), _in.NPointer(), _in.HowMany(),
-                           _in.DataPointer(), _in.EmbedPointer(), _in.Stride(),
-                           _in.Dist(), _out.DataPointer(), _out.EmbedPointer(),
-                           _out.Stride(), _out.Dist(), flag);
+      return FFTWpp::Plan(_in.Rank(), _in.NPointer(), _in.HowMany(), in,
+                          _in.EmbedPointer(), _in.Stride(), _in.Dist(), out,
+                          _out.EmbedPointer(), _out.Stride(), _out.Dist(),
+                          flag);
     } else if constexpr (NumericConcepts::Real<InType> &&
                          NumericConcepts::Real<OutType>) {
       auto kinds = std::vector<fftw_r2r_kind>();
       std::transform(
           Kinds().begin(), Kinds().end(), std::back_inserter(kinds),
           [](auto kind) { return static_cast<fftw_r2r_kind>(kind); });
-      _plan = FFTWpp::Plan(_in.Rank(), _in.NPointer(), _in.HowMany(),
-                           _in.DataPointer(), _in.EmbedPointer(), _in.Stride(),
-                           _in.Dist(), _out.DataPointer(), _out.EmbedPointer(),
-                           _out.Stride(), _out.Dist(), kinds.data(), flag);
+      return FFTWpp::Plan(_in.Rank(), _in.NPointer(), _in.HowMany(), in,
+                          _in.EmbedPointer(), _in.Stride(), _in.Dist(), out,
+                          _out.EmbedPointer(), _out.Stride(), _out.Dist(),
+                          kinds.data(), flag);
     }
-    assert(!IsNull());
+  }
+
+  void MakePlan(Flag flag) {
+    auto trace = ScopedTrace("Plan", "planning");
+    if (trace.Active()) trace.Detail(Key());
+    _copyInput = CopyInput();
+    auto in = _copyInput ? ScratchArray<InType>(_in.Layout::Extent())
+                         : _in.DataPointer();
+    _plan = NewPlan(OwnershipFlag(flag), in, _out.DataPointer());
+    _inAlignment = AlignmentOf(in);
+    _outAlignment = AlignmentOf(_out.DataPointer());
+    // Plans for wisdom only are null if there is no wisdom for them.
+    assert(!IsNull() || (_flag & WisdomOnly));
+  }
+
+  // Returns true if the fastest algorithms for the transform overwrite its
+  // input, as for C2R and halfcomplex-to-real transforms. Multi-dimensional
+  // C2R transforms have no algorithms that preserve the input.
+  bool FastestDestroysInput() const {
+    if constexpr (NumericConcepts::Complex<InType> &&
+                  NumericConcepts::Real<OutType>) {
+      return true;
+    } else if constexpr (NumericConcepts::Real<InType> &&
+                         NumericConcepts::Real<OutType>) {
+      return std::ranges::find(Kinds(), HC2R) != Kinds().end();
+    } else {
+      return false;
+    }
+  }
+
+  // Returns true if the input is preserved, either through its view or
+  // through the planning flag.
+  bool PreservesInput() const {
+    auto ownership = _in.DataOwnership();
+    if (ownership == Ownership::Unspecified) {
+      return (_flag & PreserveInput) != 0;
+    }
+    return ownership == Ownership::Preserved;
+  }
+
+  // Returns true if an input whose view is marked preserved is instead
+  // copied to a scratch array that the plan destroys, which is faster than
+  // preserving it. Inputs preserved only through the planning flag are
+  // left to fftw3, which preserves them natively where it can.
+  bool CopyInput() {
+    auto inPlace = static_cast<void*>(_in.DataPointer()) ==
+                   static_cast<void*>(_out.DataPointer());
+    return !inPlace && _in.DataOwnership() == Ownership::Preserved &&
+           FastestDestroysInput();
+  }
+
+  // Returns the flag adjusted for the ownership of the input. Consumable
+  // inputs and copied inputs are planned with DestroyInput, and other
+  // preserved inputs with PreserveInput.
+  Flag OwnershipFlag(Flag flag) const {
+    constexpr auto ownership = FFTW_DESTROY_INPUT | FFTW_PRESERVE_INPUT;
+    if (_copyInput || _in.DataOwnership() == Ownership::Consumable) {
+      return Flag{flag & ~ownership} | DestroyInput;
+    }
+    if (PreservesInput()) return Flag{flag & ~ownership} | PreserveInput;
+    return flag;
+  }
+
+  // Returns true if the arrays share the alignment of those used in
+  // planning, as required for use with the stored plan. Copied inputs are
+  // transformed from scratch arrays, which share the alignment of those
+  // used in planning, so only the output is then checked.
+  auto Aligned(InType* in, OutType* out) const {
+    return (_copyInput || AlignmentOf(in) == _inAlignment) &&
+           AlignmentOf(out) == _outAlignment;
+  }
+
+  // Return the plan for arrays of any alignment, making it on first use
+  // under the planner mutex. Scratch arrays are used so that planning does
+  // not overwrite data.
+  PlanPointer UnalignedPointer() {
+    auto unaligned = _unaligned.load(std::memory_order_acquire);
+    if (unaligned != nullptr) return unaligned;
+    auto lock = std::scoped_lock(PlannerMutex());
+    unaligned = _unaligned.load(std::memory_order_relaxed);
+    if (unaligned != nullptr) return unaligned;
+    auto trace = ScopedTrace("PlanUnaligned", "planning");
+    if (trace.Active()) trace.Detail(Key());
+    auto in = vector<InType>(_in.Layout::size());
+    auto out = vector<OutType>(_out.Layout::size());
+    unaligned =
+        NewPlan(OwnershipFlag(_flag) | Unaligned, in.data(), out.data());
+    if (unaligned == nullptr) {
+      unaligned = NewPlan(OwnershipFlag(Estimate) | Unaligned, in.data(),
+                          out.data());
+    }
+    _unaligned.store(unaligned, std::memory_order_release);
+    return unaligned;
+  }
+
+  // Execute with the stored plan if the arrays are suitably aligned, and
+  // otherwise with the unaligned plan.
+  void ExecuteAny(InType* in, OutType* out) {
+    if (Aligned(in, out)) {
+      ExecuteWith(Pointer(), in, out);
+    } else {
+      _fallbacks++;
+      ExecuteWith(UnalignedPointer(), in, out);
+    }
+  }
+
+  // Execute with the given plan, which must suit the arrays. Inputs to be
+  // preserved are first copied to the calling thread's scratch array.
+  void ExecuteWith(PlanPointer plan, InType* in, OutType* out) {
+    if (_copyInput) {
+      auto extent = _in.Layout::Extent();
+      auto scratch = ScratchArray<InType>(extent);
+      std::copy_n(in, extent, scratch);
+      in = scratch;
+    }
+    FFTWpp::Execute(plan, in, out);
+    Sample(out);
+  }
+
+  // Count subnormal values among the sampled outputs. Only the elements of
+  // the layout are sampled, and not any padding between them.
+  void Sample(OutType* out) {
+    if (_sampling == 0) return;
+    auto elements = _out.Layout::Elements();
+    auto subnormals = 0l;
+    auto samples = 0l;
+    for (auto i = std::ptrdiff_t{0}; i < elements; i += _sampling, samples++) {
+      subnormals += IsSubnormal(out[_out.Layout::Offset(i)]);
+    }
+    _subnormals += subnormals;
+    _samples += samples;
+  }
+
+  // Maximum number of bytes prefetched ahead of a transform.
+  static constexpr std::size_t PrefetchBytes = 16384;
+
+  // Issue prefetches for the first bytes of the given data.
+  static void Prefetch(const void* data, std::size_t bytes) {
+#if defined(__GNUC__)
+    auto p = static_cast<const char*>(data);
+    for (std::size_t offset = 0; offset < bytes; offset += 64) {
+      __builtin_prefetch(p + offset);
+    }
+#endif
   }
 
   auto Kinds() const
@@ -255,8 +577,12 @@ class Plan {
     return std::ranges::views::all(std::get<std::vector<RealKind>>(_kinds));
   }
 
-  // Destroy the stored plan.
+  // Destroy the stored plans.
   void Destroy() {
+    auto lock = std::scoped_lock(PlannerMutex());
+    if (auto unaligned = _unaligned.exchange(nullptr)) {
+      FFTWpp::Destroy(unaligned);
+    }
     if (IsNull()) return;
     FFTWpp::Destroy(Pointer());
     Pointer() = nullptr;
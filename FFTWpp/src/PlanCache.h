@@ -0,0 +1,253 @@
+#ifndef FFTWPP_PLANCACHE_GUARD_H
+#define FFTWPP_PLANCACHE_GUARD_H
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "Core.h"
+#include "Key.h"
+#include "Memory.h"
+#include "NumericConcepts/Numeric.hpp"
+#include "Options.h"
+#include "Plan.h"
+#include "Views.h"
+
+namespace FFTWpp {
+
+// Returns the key of a cached plan, made up of the plan key and flag.
+template <NumericConcepts::RealOrComplex InType,
+          NumericConcepts::RealOrComplex OutType, typename... Args>
+std::string CacheKey(const Ranges::Layout& in, const Ranges::Layout& out,
+                     Flag flag, Args... args) {
+  auto options = KeyOptions(args...);
+  if constexpr (NumericConcepts::Real<InType> &&
+                NumericConcepts::Real<OutType>) {
+    while (options.size() < static_cast<std::size_t>(in.Rank())) {
+      options.push_back(options.back());
+    }
+  }
+  return PlanKey<InType, OutType>(in, out, options) + "|" +
+         std::to_string(static_cast<unsigned>(flag));
+}
+
+namespace Ranges {
+
+// A plan along with the scratch arrays on which it was made. Transforms
+// are performed through new-array executes on the caller's arrays.
+template <NumericConcepts::RealOrComplex InType,
+          NumericConcepts::RealOrComplex OutType>
+requires NumericConcepts::SamePrecision<InType, OutType>
+class CachedPlan {
+ public:
+  using PlanType = Plan<std::span<InType>, std::span<OutType>>;
+
+  // Constructor given the layouts, flag and any direction or kinds. The
+  // growth in resident memory while planning, which covers the twiddle
+  // factors and buffers fftw3 allocates, is recorded against the key.
+  template <typename... Args>
+  CachedPlan(Layout in, Layout out, Flag flag, Args... args)
+      : _key{CacheKey<InType, OutType>(in, out, flag, args...)},
+        _in{Allocate<InType>(in, "PlanCache")},
+        _out{Allocate<OutType>(out, "PlanCache")},
+        _resident{ResidentBytes()},
+        _plan{View(std::span(_in), in), View(std::span(_out), out), flag,
+              args...} {
+    auto resident = ResidentBytes();
+    _resident = resident > _resident ? resident - _resident : 0;
+    PlanMemory::Get().Record(_key, _resident);
+  }
+
+  CachedPlan(const CachedPlan&) = delete;
+  CachedPlan& operator=(const CachedPlan&) = delete;
+
+  // Return the key identifying the plan within a cache.
+  const auto& Key() const { return _key; }
+
+  // Return the plan.
+  auto& Get() { return _plan; }
+
+  // Returns true if the plan could not be made.
+  bool IsNull() { return _plan.IsNull(); }
+
+  // Return the bytes of the scratch arrays.
+  std::size_t ArrayBytes() const {
+    return _in.size() * sizeof(InType) + _out.size() * sizeof(OutType);
+  }
+
+  // Return the growth in resident memory on making the plan. This is only
+  // an estimate, being rounded to pages and reduced where freed memory was
+  // reused.
+  std::size_t PlanBytes() const { return _resident; }
+
+  // Return the estimated memory footprint of the cached plan.
+  std::size_t Bytes() const { return ArrayBytes() + PlanBytes(); }
+
+  // Execute the plan on its scratch arrays.
+  void Execute() { _plan.Execute(); }
+
+  // Execute the plan on the given arrays.
+  template <NumericConcepts::RealOrComplexWritableRange NewInView,
+            NumericConcepts::RealOrComplexWritableRange NewOutView>
+  void Execute(NewInView in, NewOutView out) {
+    _plan.Execute(in, out);
+  }
+
+ private:
+  std::string _key;
+  vector<InType> _in;
+  vector<OutType> _out;
+  std::size_t _resident;
+  PlanType _plan;
+};
+
+}  // namespace Ranges
+
+// A thread-safe store of plans keyed by their layouts, types, options and
+// flag. Plans are made on scratch arrays on first request and then shared.
+// fftw3 planning is not thread-safe, so plans are made while holding the
+// cache's lock. If a memory budget is set, the least recently used plans
+// are evicted once the cached footprint exceeds it.
+class PlanCache {
+ public:
+  PlanCache() = default;
+  PlanCache(const PlanCache&) = delete;
+  PlanCache& operator=(const PlanCache&) = delete;
+
+  // Return the plan for the given layouts, flag and any direction or kinds,
+  // making it if needed. A plan that cannot be made, as with WisdomOnly and
+  // no wisdom, is returned null and is not cached.
+  template <NumericConcepts::RealOrComplex InType,
+            NumericConcepts::RealOrComplex OutType, typename... Args>
+  requires NumericConcepts::SamePrecision<InType, OutType>
+  auto Get(Ranges::Layout in, Ranges::Layout out, Flag flag, Args... args) {
+    using Cached = Ranges::CachedPlan<InType, OutType>;
+    auto key = CacheKey<InType, OutType>(in, out, flag, args...);
+    auto lock = std::scoped_lock(_mutex);
+    if (auto it = _plans.find(key); it != _plans.end()) {
+      it->second.lastUse = ++_uses;
+      return std::static_pointer_cast<Cached>(it->second.plan);
+    }
+    auto plan = std::make_shared<Cached>(in, out, flag, args...);
+    if (!plan->IsNull()) Store(plan->Key(), plan, plan->Bytes());
+    return plan;
+  }
+
+  // Add an existing plan to the cache, replacing any with the same key.
+  template <NumericConcepts::RealOrComplex InType,
+            NumericConcepts::RealOrComplex OutType>
+  void Insert(std::shared_ptr<Ranges::CachedPlan<InType, OutType>> plan) {
+    assert(plan);
+    auto lock = std::scoped_lock(_mutex);
+    Store(plan->Key(), plan, plan->Bytes());
+  }
+
+  // Returns true if a plan with the given key is cached.
+  bool Contains(const std::string& key) {
+    auto lock = std::scoped_lock(_mutex);
+    return _plans.contains(key);
+  }
+
+  // Return the number of cached plans.
+  auto Size() {
+    auto lock = std::scoped_lock(_mutex);
+    return _plans.size();
+  }
+
+  // Return the estimated memory footprint of the cached plans.
+  std::size_t Bytes() {
+    auto lock = std::scoped_lock(_mutex);
+    return _bytes;
+  }
+
+  // Return the estimated footprint of each cached plan.
+  std::map<std::string, std::size_t> BytesByKey() {
+    auto lock = std::scoped_lock(_mutex);
+    auto bytes = std::map<std::string, std::size_t>();
+    for (const auto& [key, entry] : _plans) bytes[key] = entry.bytes;
+    return bytes;
+  }
+
+  // Set the memory budget in bytes, evicting plans as needed. A budget of
+  // zero means no limit. The most recently used plan is always kept.
+  void SetBudget(std::size_t bytes) {
+    auto lock = std::scoped_lock(_mutex);
+    _budget = bytes;
+    Evict();
+  }
+
+  std::size_t Budget() {
+    auto lock = std::scoped_lock(_mutex);
+    return _budget;
+  }
+
+  // Return the number of plans evicted to meet the budget.
+  std::size_t Evictions() {
+    auto lock = std::scoped_lock(_mutex);
+    return _evictions;
+  }
+
+  // Remove all plans. Plans still held elsewhere remain valid.
+  void Clear() {
+    auto lock = std::scoped_lock(_mutex);
+    for (const auto& [key, entry] : _plans) PlanMemory::Get().Erase(key);
+    _plans.clear();
+    _bytes = 0;
+  }
+
+  // Lock and unlock the cache, as around a fork, so that no other thread
+  // holds it while the process is copied.
+  void Lock() { _mutex.lock(); }
+  void Unlock() { _mutex.unlock(); }
+
+ private:
+  struct Entry {
+    std::shared_ptr<void> plan;
+    std::size_t bytes;
+    std::uint64_t lastUse;
+  };
+
+  std::mutex _mutex;
+  std::map<std::string, Entry> _plans;
+  std::size_t _bytes = 0;
+  std::size_t _budget = 0;
+  std::size_t _evictions = 0;
+  std::uint64_t _uses = 0;
+
+  // Store a plan and apply the budget. The lock must be held.
+  void Store(const std::string& key, std::shared_ptr<void> plan,
+             std::size_t bytes) {
+    if (auto it = _plans.find(key); it != _plans.end()) {
+      _bytes -= it->second.bytes;
+    }
+    _plans[key] = Entry{std::move(plan), bytes, ++_uses};
+    _bytes += bytes;
+    Evict();
+  }
+
+  // Evict the least recently used plans until within the budget, along
+  // with their memory records. Plans still held elsewhere remain valid. The
+  // lock must be held.
+  void Evict() {
+    while (_budget > 0 && _bytes > _budget && _plans.size() > 1) {
+      auto oldest = std::ranges::min_element(_plans, {}, [](const auto& pair) {
+        return pair.second.lastUse;
+      });
+      _bytes -= oldest->second.bytes;
+      PlanMemory::Get().Erase(oldest->first);
+      _plans.erase(oldest);
+      _evictions++;
+    }
+  }
+};
+
+}  // namespace FFTWpp
+
+#endif  // FFTWPP_PLANCACHE_GUARD_H
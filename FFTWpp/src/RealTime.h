@@ -0,0 +1,157 @@
+#ifndef FFTWPP_REALTIME_GUARD_H
+#define FFTWPP_REALTIME_GUARD_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <ranges>
+#include <type_traits>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include "Core.h"
+#include "ThreadPool.h"
+#include "Timing.h"
+
+namespace FFTWpp {
+
+// Settings used in preparing a plan for real-time use.
+struct RealTimeOptions {
+  bool lockMemory = true;  // Lock the plan's arrays into memory.
+  bool lockAll = false;    // Lock all current and future process memory.
+  int warmUps = 100;       // Number of timed warm-up executes.
+  int callerCore = -1;     // Core for the calling thread, if non-negative.
+  std::vector<int> cores;  // Cores for the workers of a thread pool.
+  double outlierFactor = 4;  // Executes slower than this times the median
+                             // are reported as outliers.
+};
+
+// Results of preparing a plan for real-time use.
+struct RealTimeReport {
+  bool locked = false;  // True if the requested memory locks succeeded.
+  int pinned = 0;       // Number of threads pinned to cores.
+  double first = 0;     // Time in seconds of the first execute.
+  double median = 0;    // Median time of the warm-up executes.
+  double max = 0;       // Maximum time of the warm-up executes.
+  std::vector<double> outliers;  // Times of the warm-up outliers.
+};
+
+// Returns the size of a memory page in bytes.
+inline std::size_t PageSize() {
+#if defined(__unix__) || defined(__APPLE__)
+  return static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+#else
+  return 4096;
+#endif
+}
+
+// Read and write back a byte in each page of the given data so that all
+// pages are mapped before time-critical use.
+inline void TouchPages(void* data, std::size_t bytes) {
+  auto p = static_cast<volatile char*>(data);
+  auto page = PageSize();
+  for (std::size_t offset = 0; offset < bytes; offset += page) {
+    p[offset] = p[offset];
+  }
+  if (bytes > 0) p[bytes - 1] = p[bytes - 1];
+}
+
+// Lock the pages of the given data into memory, returning false if this is
+// not possible, as when the limit on locked memory would be exceeded.
+inline bool LockMemory(const void* data, std::size_t bytes) {
+#if defined(__unix__) || defined(__APPLE__)
+  return mlock(data, bytes) == 0;
+#else
+  return false;
+#endif
+}
+
+// Unlock pages locked by LockMemory, returning false on failure.
+inline bool UnlockMemory(const void* data, std::size_t bytes) {
+#if defined(__unix__) || defined(__APPLE__)
+  return munlock(data, bytes) == 0;
+#else
+  return false;
+#endif
+}
+
+// Lock all current and future pages of the process into memory. This also
+// covers the twiddle factors and buffers allocated internally by fftw3.
+inline bool LockAllMemory() {
+#if defined(__unix__) || defined(__APPLE__)
+  return mlockall(MCL_CURRENT | MCL_FUTURE) == 0;
+#else
+  return false;
+#endif
+}
+
+// Prepare a plan and its arrays for real-time use. The pages of the arrays
+// are touched and optionally locked, threads are pinned to the configured
+// cores, any plan for unaligned arrays is made, and the plan is executed
+// repeatedly so that later executes avoid page faults and cold caches. The
+// input is restored afterwards, but the output is overwritten. Warm-up
+// times well above the median, which indicate interference that
+// preparation has not removed, are reported.
+template <typename PlanType>
+RealTimeReport PrepareRealTime(PlanType& plan,
+                               const RealTimeOptions& options = {},
+                               ThreadPool* pool = nullptr) {
+  auto report = RealTimeReport{};
+  auto in = plan.InData();
+  auto out = plan.OutData();
+  auto inBytes = plan.InLayout().Extent() * sizeof(*in);
+  auto outBytes = plan.OutLayout().Extent() * sizeof(*out);
+
+  if (options.callerCore >= 0) {
+    report.pinned += PinCurrentThread(options.callerCore);
+  }
+  if (pool) report.pinned += pool->Pin(options.cores);
+
+  TouchPages(in, inBytes);
+  TouchPages(out, outBytes);
+  report.locked = true;
+  if (options.lockAll) report.locked = LockAllMemory();
+  if (options.lockMemory) {
+    report.locked = LockMemory(in, inBytes) && report.locked;
+    report.locked = LockMemory(out, outBytes) && report.locked;
+  }
+
+  if constexpr (requires { plan.PrepareUnaligned(); }) {
+    plan.PrepareUnaligned();
+  }
+
+  using InType = std::remove_pointer_t<decltype(in)>;
+  auto copy = vector<InType>(in, in + plan.InLayout().Extent());
+  auto start = std::chrono::steady_clock::now();
+  plan.Execute();
+  report.first = Seconds(start);
+  auto times = std::vector<double>();
+  for (auto i = 0; i < options.warmUps; i++) {
+    start = std::chrono::steady_clock::now();
+    plan.Execute();
+    times.push_back(Seconds(start));
+  }
+  std::ranges::copy(copy, in);
+
+  if (!times.empty()) {
+    auto sorted = times;
+    auto middle = sorted.begin() + sorted.size() / 2;
+    std::ranges::nth_element(sorted, middle);
+    report.median = *middle;
+    report.max = std::ranges::max(times);
+    for (auto time : times) {
+      if (time > options.outlierFactor * report.median) {
+        report.outliers.push_back(time);
+      }
+    }
+  }
+  return report;
+}
+
+}  // namespace FFTWpp
+
+#endif  // FFTWPP_REALTIME_GUARD_H
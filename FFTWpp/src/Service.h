@@ -0,0 +1,794 @@
+#ifndef FFTWPP_SERVICE_GUARD_H
+#define FFTWPP_SERVICE_GUARD_H
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <cerrno>
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <ranges>
+#include <span>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#include "Core.h"
+#include "NumericConcepts/Numeric.hpp"
+#include "Options.h"
+#include "PlanCache.h"
+#include "ThreadPool.h"
+#include "Views.h"
+#include "Wisdom.h"
+#include "fftw3.h"
+
+namespace FFTWpp {
+
+// True if the transform service is supported, which requires Linux for
+// memfd segments and descriptor passing over Unix sockets.
+#if defined(__linux__)
+constexpr bool HasService = true;
+#else
+constexpr bool HasService = false;
+#endif
+
+#if defined(__linux__)
+
+// Largest rank of the transforms handled by TransformService.
+constexpr int ServiceMaxRank = 3;
+
+namespace Service {
+
+// Returns a new identifier for a buffer or job, unique within the process.
+inline std::uint64_t NextId() {
+  static auto id = std::atomic<std::uint64_t>{0};
+  return ++id;
+}
+
+}  // namespace Service
+
+// A memory segment backed by an anonymous memfd file, which can be shared
+// with another process by passing its descriptor over a Unix socket.
+// Mappings are page-aligned, and so meet the alignment of FFTWpp::vector,
+// and spans within the segment can be used as the data of views.
+class SharedBuffer {
+ public:
+  SharedBuffer() = default;
+
+  // Create a segment of the given size. The buffer is invalid on failure.
+  static SharedBuffer Create(std::size_t bytes) {
+    assert(bytes > 0);
+    auto fd = memfd_create("FFTWpp", MFD_CLOEXEC);
+    if (fd < 0) return {};
+    if (ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+      close(fd);
+      return {};
+    }
+    return Map(fd, bytes, Service::NextId());
+  }
+
+  // Map a segment received from another process, taking ownership of its
+  // descriptor. The buffer is invalid on failure.
+  static SharedBuffer Map(int fd, std::size_t bytes, std::uint64_t id) {
+    auto buffer = SharedBuffer();
+    buffer._fd = fd;
+    buffer._id = id;
+    if (bytes == 0) return buffer;
+    auto data =
+        mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (data == MAP_FAILED) return buffer;
+    buffer._data = data;
+    buffer._bytes = bytes;
+    return buffer;
+  }
+
+  SharedBuffer(const SharedBuffer&) = delete;
+  SharedBuffer& operator=(const SharedBuffer&) = delete;
+
+  SharedBuffer(SharedBuffer&& other) noexcept { Swap(other); }
+
+  SharedBuffer& operator=(SharedBuffer&& other) noexcept {
+    if (this != &other) {
+      Unmap();
+      Swap(other);
+    }
+    return *this;
+  }
+
+  ~SharedBuffer() { Unmap(); }
+
+  // Returns true if the segment is mapped.
+  bool Valid() const { return _data != nullptr; }
+
+  int Descriptor() const { return _fd; }
+  std::size_t Bytes() const { return _bytes; }
+  std::uint64_t Id() const { return _id; }
+  void* Data() const { return _data; }
+
+  // Returns true if the given number of elements of type T at the given
+  // offset in bytes lie within the segment and are suitably aligned.
+  template <typename T>
+  bool Contains(std::size_t offset, std::size_t count) const {
+    return offset % alignof(T) == 0 && offset <= _bytes &&
+           count <= (_bytes - offset) / sizeof(T);
+  }
+
+  // Return a span of elements of type T at the given offset in bytes.
+  template <typename T>
+  std::span<T> Span(std::size_t offset, std::size_t count) const {
+    assert(Contains<T>(offset, count));
+    return {reinterpret_cast<T*>(static_cast<std::byte*>(_data) + offset),
+            count};
+  }
+
+ private:
+  int _fd = -1;
+  void* _data = nullptr;
+  std::size_t _bytes = 0;
+  std::uint64_t _id = 0;
+
+  void Swap(SharedBuffer& other) {
+    std::swap(_fd, other._fd);
+    std::swap(_data, other._data);
+    std::swap(_bytes, other._bytes);
+    std::swap(_id, other._id);
+  }
+
+  void Unmap() {
+    if (_data) munmap(_data, _bytes);
+    if (_fd >= 0) close(_fd);
+    _data = nullptr;
+    _fd = -1;
+  }
+};
+
+// A layout in a fixed-size form for sending between processes.
+struct LayoutMessage {
+  std::int32_t rank = 0;
+  std::int32_t howMany = 0;
+  std::int32_t stride = 0;
+  std::int32_t dist = 0;
+  std::array<std::int32_t, ServiceMaxRank> n{};
+  std::array<std::int32_t, ServiceMaxRank> embed{};
+
+  static LayoutMessage From(const Ranges::Layout& layout) {
+    assert(layout.Rank() <= ServiceMaxRank);
+    auto message = LayoutMessage{layout.Rank(), layout.HowMany(),
+                                 layout.Stride(), layout.Dist()};
+    std::ranges::copy(layout.N(), message.n.begin());
+    std::ranges::copy(layout.Embed(), message.embed.begin());
+    return message;
+  }
+
+  Ranges::Layout ToLayout() const {
+    return Ranges::Layout(rank, std::span(n.data(), rank), howMany,
+                          std::span(embed.data(), rank), stride, dist);
+  }
+
+  // Returns true if the fields describe a layout.
+  bool Valid() const {
+    if (rank < 1 || rank > ServiceMaxRank) return false;
+    if (howMany < 1 || stride < 1 || dist < 0) return false;
+    for (auto d = 0; d < rank; d++) {
+      if (n[d] < 1 || embed[d] < (d == 0 ? 1 : n[d])) return false;
+    }
+    return true;
+  }
+};
+
+// Types of request sent to a TransformService, and of its replies.
+enum class ServiceRequest : std::uint32_t {
+  Register,
+  Release,
+  Transform,
+  Reply
+};
+
+enum class ServicePrecision : std::uint32_t { Float, Double, LongDouble };
+
+enum class ServiceTransform : std::uint32_t { C2C, R2C, C2R, R2R };
+
+// A request to a TransformService or its reply. Each is sent as a single
+// packet, with the descriptor of a buffer attached when registering it.
+struct ServiceMessage {
+  ServiceRequest request = ServiceRequest::Reply;
+  std::int32_t status = 0;     // Status of a reply, zero on success.
+  std::uint64_t id = 0;        // Job or buffer, echoed in the reply.
+  std::uint64_t buffer = 0;    // Buffer holding the data of a transform.
+  std::uint64_t bytes = 0;     // Size of a buffer being registered.
+  std::uint64_t inOffset = 0;  // Offsets in bytes of the data in the buffer.
+  std::uint64_t outOffset = 0;
+  ServicePrecision precision = ServicePrecision::Double;
+  ServiceTransform transform = ServiceTransform::C2C;
+  std::int32_t direction = FFTW_FORWARD;
+  std::uint32_t flag = FFTW_MEASURE;
+  std::array<std::int32_t, ServiceMaxRank> kinds{};
+  LayoutMessage in{};
+  LayoutMessage out{};
+};
+
+namespace Service {
+
+// Send a message, with a descriptor attached if one is given.
+inline bool Send(int socket, const ServiceMessage& message, int fd = -1,
+                 int flags = 0) {
+  auto data = message;
+  auto iov = iovec{&data, sizeof(data)};
+  auto header = msghdr{};
+  header.msg_iov = &iov;
+  header.msg_iovlen = 1;
+  alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))] = {};
+  if (fd >= 0) {
+    header.msg_control = control;
+    header.msg_controllen = sizeof(control);
+    auto cmsg = CMSG_FIRSTHDR(&header);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+    std::memcpy(CMSG_DATA(cmsg), &fd, sizeof(int));
+  }
+  return sendmsg(socket, &header, flags | MSG_NOSIGNAL) ==
+         static_cast<ssize_t>(sizeof(data));
+}
+
+// Receive a message, along with any descriptor attached, which is
+// otherwise set to -1. Returns the result of recvmsg, which is zero once
+// the peer has closed the connection, or -1 for an incomplete message.
+inline ssize_t Receive(int socket, ServiceMessage& message, int& fd,
+                       int flags = 0) {
+  fd = -1;
+  auto iov = iovec{&message, sizeof(message)};
+  auto header = msghdr{};
+  header.msg_iov = &iov;
+  header.msg_iovlen = 1;
+  alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))] = {};
+  header.msg_control = control;
+  header.msg_controllen = sizeof(control);
+  auto received = recvmsg(socket, &header, flags | MSG_CMSG_CLOEXEC);
+  for (auto cmsg = CMSG_FIRSTHDR(&header); received > 0 && cmsg;
+       cmsg = CMSG_NXTHDR(&header, cmsg)) {
+    if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS) {
+      std::memcpy(&fd, CMSG_DATA(cmsg), sizeof(int));
+    }
+  }
+  if (received > 0 && received != static_cast<ssize_t>(sizeof(message))) {
+    if (fd >= 0) close(fd);
+    fd = -1;
+    errno = EPROTO;
+    return -1;
+  }
+  return received;
+}
+
+// Returns true if a client may plan with the flag. Plans are made on the
+// service's loop, so only Estimate and Measure are allowed, along with the
+// input modifiers, so that one client cannot stall the others.
+inline bool AllowedFlag(unsigned flag) {
+  constexpr auto allowed =
+      unsigned{FFTW_ESTIMATE | FFTW_DESTROY_INPUT | FFTW_PRESERVE_INPUT};
+  return (flag & ~allowed) == 0;
+}
+
+// Returns true if the ranges of bytes [a, a + m) and [b, b + n) overlap.
+inline bool Overlaps(const void* a, std::size_t m, const void* b,
+                     std::size_t n) {
+  auto x = reinterpret_cast<std::uintptr_t>(a);
+  auto y = reinterpret_cast<std::uintptr_t>(b);
+  return x < y + n && y < x + m;
+}
+
+// Return a Unix socket address for the given path.
+inline sockaddr_un Address(const std::string& path) {
+  auto address = sockaddr_un{};
+  address.sun_family = AF_UNIX;
+  assert(path.size() < sizeof(address.sun_path));
+  std::ranges::copy(path, address.sun_path);
+  return address;
+}
+
+template <NumericConcepts::Real Real>
+constexpr ServicePrecision PrecisionOf() {
+  if constexpr (NumericConcepts::Float<Real>) return ServicePrecision::Float;
+  if constexpr (NumericConcepts::Double<Real>) return ServicePrecision::Double;
+  if constexpr (NumericConcepts::LongDouble<Real>) {
+    return ServicePrecision::LongDouble;
+  }
+}
+
+template <NumericConcepts::RealOrComplex InType,
+          NumericConcepts::RealOrComplex OutType>
+constexpr ServiceTransform TransformOf() {
+  if constexpr (NumericConcepts::Complex<InType> &&
+                NumericConcepts::Complex<OutType>) {
+    return ServiceTransform::C2C;
+  } else if constexpr (NumericConcepts::Real<InType> &&
+                       NumericConcepts::Complex<OutType>) {
+    return ServiceTransform::R2C;
+  } else if constexpr (NumericConcepts::Complex<InType> &&
+                       NumericConcepts::Real<OutType>) {
+    return ServiceTransform::C2R;
+  } else {
+    return ServiceTransform::R2R;
+  }
+}
+
+// Store the direction or kinds of a transform in a message. Kinds not
+// given repeat the last, as for Plan.
+inline void SetOptions(ServiceMessage&) {}
+
+inline void SetOptions(ServiceMessage& message, Direction direction) {
+  message.direction = direction;
+}
+
+inline void SetOptions(ServiceMessage& message,
+                       const std::vector<RealKind>& kinds) {
+  assert(!kinds.empty() && kinds.size() <= ServiceMaxRank);
+  for (auto d = std::size_t{0}; d < ServiceMaxRank; d++) {
+    message.kinds[d] = static_cast<fftw_r2r_kind>(
+        kinds[std::min(d, kinds.size() - 1)]);
+  }
+}
+
+template <typename... RealKinds>
+requires(sizeof...(RealKinds) > 0) and
+        (std::same_as<RealKinds, RealKind> && ...)
+void SetOptions(ServiceMessage& message, RealKinds... kinds) {
+  SetOptions(message, std::vector<RealKind>{kinds...});
+}
+
+// Returns true if the layouts are those of a transform between the types.
+template <NumericConcepts::RealOrComplex InType,
+          NumericConcepts::RealOrComplex OutType>
+bool Matches(const LayoutMessage& in, const LayoutMessage& out) {
+  if (!in.Valid() || !out.Valid()) return false;
+  if (in.rank != out.rank || in.howMany != out.howMany) return false;
+  auto last = in.rank - 1;
+  for (auto d = 0; d < last; d++) {
+    if (in.n[d] != out.n[d]) return false;
+  }
+  if constexpr (NumericConcepts::Real<InType> &&
+                NumericConcepts::Complex<OutType>) {
+    return out.n[last] == in.n[last] / 2 + 1;
+  } else if constexpr (NumericConcepts::Complex<InType> &&
+                       NumericConcepts::Real<OutType>) {
+    return in.n[last] == out.n[last] / 2 + 1;
+  } else {
+    return in.n[last] == out.n[last];
+  }
+}
+
+}  // namespace Service
+
+// Client of a TransformService. Buffers are allocated as shared segments
+// and registered with the service, and transforms of data within them are
+// submitted as jobs. Jobs submitted before waiting are read by the service
+// together, and those for the same plan are executed as a batch. A client
+// must be used from one thread at a time.
+class TransformClient {
+ public:
+  // Connect to the service listening at the given path.
+  explicit TransformClient(const std::string& path)
+      : _socket{socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0)} {
+    auto address = Service::Address(path);
+    if (_socket >= 0 &&
+        connect(_socket, reinterpret_cast<sockaddr*>(&address),
+                sizeof(address)) != 0) {
+      close(_socket);
+      _socket = -1;
+    }
+  }
+
+  TransformClient(const TransformClient&) = delete;
+  TransformClient& operator=(const TransformClient&) = delete;
+
+  ~TransformClient() {
+    if (_socket >= 0) close(_socket);
+  }
+
+  // Returns true if connected to the service.
+  bool Connected() const { return _socket >= 0; }
+
+  // Create a shared buffer of the given size and register it with the
+  // service. The buffer is invalid on failure.
+  SharedBuffer Allocate(std::size_t bytes) {
+    auto buffer = SharedBuffer::Create(bytes);
+    if (!buffer.Valid()) return buffer;
+    auto message = ServiceMessage{.request = ServiceRequest::Register,
+                                  .id = buffer.Id(),
+                                  .bytes = bytes};
+    if (!Service::Send(_socket, message, buffer.Descriptor()) ||
+        Await(buffer.Id()) != 0) {
+      return {};
+    }
+    return buffer;
+  }
+
+  // Release a buffer on the service. Jobs using it must have finished.
+  void Release(const SharedBuffer& buffer) {
+    auto message = ServiceMessage{.request = ServiceRequest::Release,
+                                  .buffer = buffer.Id()};
+    Service::Send(_socket, message);
+  }
+
+  // Submit a transform between data at the given offsets in bytes within a
+  // registered buffer, returning the job's identifier, or zero on failure.
+  // The remaining arguments are the direction or kinds as needed. The data
+  // must not be used until the job has been waited for.
+  template <NumericConcepts::RealOrComplex InType,
+            NumericConcepts::RealOrComplex OutType, typename... Args>
+  requires NumericConcepts::SamePrecision<InType, OutType>
+  std::uint64_t Submit(const SharedBuffer& buffer, std::size_t inOffset,
+                       const Ranges::Layout& in, std::size_t outOffset,
+                       const Ranges::Layout& out, Flag flag, Args... args) {
+    using Real = NumericConcepts::RemoveComplex<InType>;
+    auto message = ServiceMessage{.request = ServiceRequest::Transform,
+                                  .id = Service::NextId(),
+                                  .buffer = buffer.Id(),
+                                  .inOffset = inOffset,
+                                  .outOffset = outOffset};
+    message.precision = Service::PrecisionOf<Real>();
+    message.transform = Service::TransformOf<InType, OutType>();
+    message.flag = flag;
+    message.in = LayoutMessage::From(in);
+    message.out = LayoutMessage::From(out);
+    Service::SetOptions(message, args...);
+    return Service::Send(_socket, message) ? message.id : 0;
+  }
+
+  // Wait for a job, returning true if it succeeded.
+  bool Wait(std::uint64_t job) { return job != 0 && Await(job) == 0; }
+
+  // Submit a transform and wait for it, returning true if it succeeded.
+  template <NumericConcepts::RealOrComplex InType,
+            NumericConcepts::RealOrComplex OutType, typename... Args>
+  requires NumericConcepts::SamePrecision<InType, OutType>
+  bool Transform(const SharedBuffer& buffer, std::size_t inOffset,
+                 const Ranges::Layout& in, std::size_t outOffset,
+                 const Ranges::Layout& out, Flag flag, Args... args) {
+    return Wait(Submit<InType, OutType>(buffer, inOffset, in, outOffset, out,
+                                        flag, args...));
+  }
+
+ private:
+  int _socket;
+  std::map<std::uint64_t, std::int32_t> _replies;
+
+  // Wait for the reply with the given identifier, returning its status,
+  // or -1 if the connection fails. Other replies are kept for later.
+  std::int32_t Await(std::uint64_t id) {
+    while (true) {
+      if (auto it = _replies.find(id); it != _replies.end()) {
+        auto status = it->second;
+        _replies.erase(it);
+        return status;
+      }
+      auto message = ServiceMessage{};
+      auto fd = -1;
+      if (Service::Receive(_socket, message, fd) <= 0) return -1;
+      if (fd >= 0) close(fd);
+      _replies[message.id] = message.status;
+    }
+  }
+};
+
+// A local service that performs transforms for other processes, so that
+// the plans, wisdom and threads are held once per host rather than once per
+// process. Clients connect over a Unix domain socket and pass their data
+// through shared memory segments, which are mapped once on registration
+// and used without copying. Jobs read together are grouped by plan, and
+// each group is executed as a batch shared between the workers of a
+// thread pool. Plans are kept in a PlanCache, and are made out-of-place,
+// so jobs whose input and output overlap, or whose data overlap that of
+// another job in the batch, are rejected. Jobs may only plan with Estimate
+// or Measure. Replies are sent without blocking, and a client that does
+// not read them is disconnected.
+class TransformService {
+ public:
+  // Listen at the given path, replacing any stale socket there. If a base
+  // filename for wisdom is given, wisdom is imported from it and exported
+  // to it on destruction.
+  explicit TransformService(std::string path,
+                            int threads = std::thread::hardware_concurrency(),
+                            std::string wisdom = "")
+      : _path{std::move(path)}, _wisdom{std::move(wisdom)}, _pool{threads} {
+    if (!_wisdom.empty()) ImportWisdomFiles(_wisdom);
+    if (pipe2(_wake, O_CLOEXEC | O_NONBLOCK) != 0) return;
+    _listen = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    auto address = Service::Address(_path);
+    unlink(_path.c_str());
+    if (_listen >= 0 &&
+        (bind(_listen, reinterpret_cast<sockaddr*>(&address),
+              sizeof(address)) != 0 ||
+         listen(_listen, SOMAXCONN) != 0)) {
+      close(_listen);
+      _listen = -1;
+    }
+  }
+
+  TransformService(const TransformService&) = delete;
+  TransformService& operator=(const TransformService&) = delete;
+
+  ~TransformService() {
+    for (const auto& [fd, connection] : _connections) close(fd);
+    _connections.clear();
+    if (_listen >= 0) {
+      close(_listen);
+      unlink(_path.c_str());
+    }
+    for (auto fd : _wake) {
+      if (fd >= 0) close(fd);
+    }
+    if (!_wisdom.empty()) ExportWisdomFiles(_wisdom);
+  }
+
+  // Returns true if the service is listening for clients.
+  bool Listening() const { return _listen >= 0; }
+
+  // Serve clients until Stop is called.
+  void Run() {
+    while (Listening() && !_stop.load()) {
+      auto fds =
+          std::vector<pollfd>{{_listen, POLLIN, 0}, {_wake[0], POLLIN, 0}};
+      for (const auto& [fd, connection] : _connections) {
+        fds.push_back({fd, POLLIN, 0});
+      }
+      if (poll(fds.data(), fds.size(), -1) < 0) {
+        if (errno == EINTR) continue;
+        return;
+      }
+      if (fds[0].revents & POLLIN) Accept();
+      if (fds[1].revents & POLLIN) {
+        auto bytes = std::array<char, 64>{};
+        while (read(_wake[0], bytes.data(), bytes.size()) > 0) {
+        }
+      }
+      auto jobs = std::vector<Job>();
+      for (const auto& fd : fds | std::views::drop(2)) {
+        if (fd.revents) Read(fd.fd, jobs);
+      }
+      Execute(jobs);
+    }
+  }
+
+  // Stop serving. This may be called from any thread.
+  void Stop() {
+    _stop = true;
+    if (_wake[1] >= 0) {
+      [[maybe_unused]] auto written = write(_wake[1], "", 1);
+    }
+  }
+
+  // Return the numbers of jobs executed and of batches they formed.
+  long Jobs() const { return _jobs.load(); }
+  long Batches() const { return _batches.load(); }
+
+  // Return the cache holding the plans.
+  PlanCache& Cache() { return _cache; }
+
+ private:
+  struct Job {
+    int client;
+    ServiceMessage message;
+  };
+
+  std::string _path;
+  std::string _wisdom;
+  ThreadPool _pool;
+  PlanCache _cache;
+  int _listen = -1;
+  int _wake[2] = {-1, -1};
+  std::atomic<bool> _stop = false;
+  std::atomic<long> _jobs = 0;
+  std::atomic<long> _batches = 0;
+
+  // Buffers registered by each connected client.
+  std::map<int, std::map<std::uint64_t, SharedBuffer>> _connections;
+
+  void Accept() {
+    while (true) {
+      auto fd = accept4(_listen, nullptr, nullptr, SOCK_CLOEXEC);
+      if (fd < 0) return;
+      _connections[fd];
+      // Only accept the connections already waiting.
+      auto waiting = pollfd{_listen, POLLIN, 0};
+      if (poll(&waiting, 1, 0) <= 0) return;
+    }
+  }
+
+  void Disconnect(int fd) {
+    close(fd);
+    _connections.erase(fd);
+  }
+
+  // Send a reply, returning false if the client cannot take it.
+  bool Reply(int client, ServiceMessage message, std::int32_t status) {
+    message.request = ServiceRequest::Reply;
+    message.status = status;
+    return Service::Send(client, message, -1, MSG_DONTWAIT);
+  }
+
+  // Read the messages waiting from a client, handling registrations and
+  // collecting transform jobs.
+  void Read(int client, std::vector<Job>& jobs) {
+    while (true) {
+      auto message = ServiceMessage{};
+      auto fd = -1;
+      auto received = Service::Receive(client, message, fd, MSG_DONTWAIT);
+      if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return;
+      if (received <= 0) return Disconnect(client);
+      switch (message.request) {
+        case ServiceRequest::Register: {
+          auto buffer = SharedBuffer::Map(fd, message.bytes, message.id);
+          auto valid = fd >= 0 && buffer.Valid();
+          if (valid) _connections[client][message.id] = std::move(buffer);
+          if (!Reply(client, message, valid ? 0 : EINVAL)) {
+            return Disconnect(client);
+          }
+          break;
+        }
+        case ServiceRequest::Release:
+          _connections[client].erase(message.buffer);
+          break;
+        case ServiceRequest::Transform:
+          jobs.push_back(Job{client, message});
+          break;
+        default:
+          if (!Reply(client, message, EPROTO)) return Disconnect(client);
+      }
+    }
+  }
+
+  // Return a key grouping jobs that share a plan.
+  static std::string JobKey(const ServiceMessage& message) {
+    auto key = std::ostringstream();
+    auto layout = [&](const LayoutMessage& layout) {
+      key << "|" << layout.rank << "," << layout.howMany << ","
+          << layout.stride << "," << layout.dist;
+      for (auto d = 0; d < ServiceMaxRank; d++) {
+        key << "," << layout.n[d] << "," << layout.embed[d];
+      }
+    };
+    key << static_cast<int>(message.precision) << ","
+        << static_cast<int>(message.transform) << "," << message.direction
+        << "," << message.flag;
+    for (auto kind : message.kinds) key << "," << kind;
+    layout(message.in);
+    layout(message.out);
+    return key.str();
+  }
+
+  // Execute the jobs in batches sharing a plan, and reply to each.
+  void Execute(std::vector<Job>& jobs) {
+    auto batches = std::map<std::string, std::vector<Job*>>();
+    for (auto& job : jobs) batches[JobKey(job.message)].push_back(&job);
+    for (auto& [key, batch] : batches) {
+      switch (batch.front()->message.precision) {
+        case ServicePrecision::Float:
+          ExecuteBatch<float>(batch);
+          break;
+        case ServicePrecision::Double:
+          ExecuteBatch<double>(batch);
+          break;
+        case ServicePrecision::LongDouble:
+          ExecuteBatch<long double>(batch);
+          break;
+        default:
+          for (auto job : batch) job->message.status = EINVAL;
+      }
+    }
+    for (const auto& job : jobs) {
+      if (_connections.contains(job.client) &&
+          !Reply(job.client, job.message, job.message.status)) {
+        Disconnect(job.client);
+      }
+    }
+  }
+
+  template <NumericConcepts::Real Real>
+  void ExecuteBatch(std::vector<Job*>& batch) {
+    using Complex = std::complex<Real>;
+    const auto& message = batch.front()->message;
+    switch (message.transform) {
+      case ServiceTransform::C2C:
+        if (message.direction != FFTW_FORWARD &&
+            message.direction != FFTW_BACKWARD) {
+          break;
+        }
+        return ExecuteBatch<Complex, Complex>(batch,
+                                              Direction{message.direction});
+      case ServiceTransform::R2C:
+        return ExecuteBatch<Real, Complex>(batch);
+      case ServiceTransform::C2R:
+        return ExecuteBatch<Complex, Real>(batch);
+      case ServiceTransform::R2R: {
+        auto rank = std::clamp(message.in.rank, 1, ServiceMaxRank);
+        auto kinds = std::vector<RealKind>();
+        for (auto kind : message.kinds | std::views::take(rank)) {
+          if (kind < FFTW_R2HC || kind > FFTW_RODFT11) break;
+          kinds.push_back(static_cast<fftw_r2r_kind>(kind));
+        }
+        if (static_cast<int>(kinds.size()) < rank) break;
+        return ExecuteBatch<Real, Real>(batch, kinds);
+      }
+    }
+    for (auto job : batch) job->message.status = EINVAL;
+  }
+
+  template <NumericConcepts::RealOrComplex InType,
+            NumericConcepts::RealOrComplex OutType, typename... Args>
+  void ExecuteBatch(std::vector<Job*>& batch, Args... args) {
+    const auto& message = batch.front()->message;
+    if (!Service::Matches<InType, OutType>(message.in, message.out) ||
+        !Service::AllowedFlag(message.flag)) {
+      for (auto job : batch) job->message.status = EINVAL;
+      return;
+    }
+    auto in = message.in.ToLayout();
+    auto out = message.out.ToLayout();
+    auto inExtent = static_cast<std::size_t>(in.Extent());
+    auto outExtent = static_cast<std::size_t>(out.Extent());
+    auto inBytes = inExtent * sizeof(InType);
+    auto outBytes = outExtent * sizeof(OutType);
+    auto pairs = std::vector<std::pair<InType*, OutType*>>();
+    // Returns true if the data of a job overlap those of an earlier one.
+    auto overlaps = [&](InType* x, OutType* y) {
+      return std::ranges::any_of(pairs, [&](const auto& pair) {
+        return Service::Overlaps(x, inBytes, pair.first, inBytes) ||
+               Service::Overlaps(x, inBytes, pair.second, outBytes) ||
+               Service::Overlaps(y, outBytes, pair.first, inBytes) ||
+               Service::Overlaps(y, outBytes, pair.second, outBytes);
+      });
+    };
+    for (auto job : batch) {
+      job->message.status = EINVAL;
+      auto connection = _connections.find(job->client);
+      if (connection == _connections.end()) continue;
+      auto& buffers = connection->second;
+      auto it = buffers.find(job->message.buffer);
+      if (it == buffers.end() ||
+          !it->second.Contains<InType>(job->message.inOffset, inExtent) ||
+          !it->second.Contains<OutType>(job->message.outOffset, outExtent)) {
+        continue;
+      }
+      auto x = it->second.Span<InType>(job->message.inOffset, inExtent).data();
+      auto y =
+          it->second.Span<OutType>(job->message.outOffset, outExtent).data();
+      if (Service::Overlaps(x, inBytes, y, outBytes) || overlaps(x, y)) {
+        continue;
+      }
+      job->message.status = 0;
+      pairs.emplace_back(x, y);
+    }
+    if (pairs.empty()) return;
+    auto plan = _cache.Get<InType, OutType>(in, out, Flag{message.flag},
+                                            args...);
+    // Cached plans were made on scratch arrays, and jobs may lie at offsets
+    // of any alignment.
+    plan->Get().PrepareUnaligned();
+    plan->Get().Execute(std::span<const std::pair<InType*, OutType*>>(pairs),
+                        &_pool);
+    _jobs += static_cast<long>(pairs.size());
+    _batches++;
+  }
+};
+
+#endif  // defined(__linux__)
+
+}  // namespace FFTWpp
+
+#endif  // FFTWPP_SERVICE_GUARD_H
@@ -0,0 +1,147 @@
+#ifndef FFTWPP_THREADPOOL_GUARD_H
+#define FFTWPP_THREADPOOL_GUARD_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <latch>
+#include <mutex>
+#include <span>
+#include <stop_token>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace FFTWpp {
+
+// Restrict the given thread to run on a single core. Returns false if this
+// is not supported or the core is unavailable.
+inline bool PinThread(std::thread::native_handle_type thread, int core) {
+#if defined(__linux__)
+  auto set = cpu_set_t{};
+  CPU_ZERO(&set);
+  CPU_SET(core, &set);
+  return pthread_setaffinity_np(thread, sizeof(set), &set) == 0;
+#else
+  return false;
+#endif
+}
+
+// Restrict the calling thread to run on a single core.
+inline bool PinCurrentThread(int core) {
+#if defined(__linux__)
+  return PinThread(pthread_self(), core);
+#else
+  return false;
+#endif
+}
+
+// A fixed-size pool of worker threads.
+class ThreadPool {
+ public:
+  // Construct a pool with the given number of workers.
+  explicit ThreadPool(int threads = std::thread::hardware_concurrency()) {
+    threads = std::max(threads, 1);
+    for (auto i = 0; i < threads; i++) {
+      _threads.emplace_back([this](std::stop_token stop) { Work(stop); });
+    }
+  }
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  // Stop and join the workers once any queued tasks are finished.
+  ~ThreadPool() {
+    for (auto& thread : _threads) thread.request_stop();
+    _condition.notify_all();
+  }
+
+  // Return the number of workers.
+  auto Size() const { return static_cast<int>(_threads.size()); }
+
+  // Pin worker i to cores[i % cores.size()], returning the number of
+  // workers pinned.
+  int Pin(std::span<const int> cores) {
+    if (cores.empty()) return 0;
+    auto pinned = 0;
+    for (auto i = std::size_t{0}; i < _threads.size(); i++) {
+      pinned += PinThread(_threads[i].native_handle(),
+                          cores[i % cores.size()]);
+    }
+    return pinned;
+  }
+
+  // Queue a task to be run by one of the workers.
+  void Submit(std::function<void()> task) {
+    {
+      auto lock = std::scoped_lock(_mutex);
+      _tasks.push_back(std::move(task));
+    }
+    _condition.notify_one();
+  }
+
+  // Call f(i) for i in [0, count), sharing the indices dynamically between
+  // the workers and the calling thread. Returns once all calls are done.
+  // Called from one of the pool's own workers, as by a threaded fftw3 plan
+  // executed on the pool, the calls are made in turn on that worker, since
+  // waiting for helpers could otherwise block every worker.
+  template <typename F>
+  void ParallelFor(int count, F&& f) {
+    auto helpers = std::min(Size(), count - 1);
+    if (helpers <= 0 || Worker() == this) {
+      for (auto i = 0; i < count; i++) f(i);
+      return;
+    }
+    auto next = std::atomic<int>{0};
+    auto done = std::latch{helpers};
+    auto loop = [&]() {
+      for (auto i = next++; i < count; i = next++) f(i);
+    };
+    for (auto i = 0; i < helpers; i++) {
+      Submit([&]() {
+        loop();
+        done.count_down();
+      });
+    }
+    loop();
+    done.wait();
+  }
+
+ private:
+  std::mutex _mutex;
+  std::condition_variable_any _condition;
+  std::deque<std::function<void()>> _tasks;
+  std::vector<std::jthread> _threads;
+
+  // Return the pool whose worker is the calling thread, if any.
+  static const ThreadPool*& Worker() {
+    thread_local auto pool = static_cast<const ThreadPool*>(nullptr);
+    return pool;
+  }
+
+  void Work(std::stop_token stop) {
+    Worker() = this;
+    while (true) {
+      auto task = std::function<void()>();
+      {
+        auto lock = std::unique_lock(_mutex);
+        _condition.wait(lock, stop, [this]() { return !_tasks.empty(); });
+        if (_tasks.empty()) return;
+        task = std::move(_tasks.front());
+        _tasks.pop_front();
+      }
+      task();
+    }
+  }
+};
+
+}  // namespace FFTWpp
+
+#endif  // FFTWPP_THREADPOOL_GUARD_H
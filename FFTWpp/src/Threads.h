@@ -0,0 +1,91 @@
+#ifndef FFTWPP_THREADS_GUARD_H
+#define FFTWPP_THREADS_GUARD_H
+
+#include <cassert>
+#include <cstddef>
+#include <mutex>
+
+#include "Core.h"
+#include "Denormals.h"
+#include "ThreadPool.h"
+#include "fftw3.h"
+
+namespace FFTWpp {
+
+// True if the library was built against the threaded fftw3 libraries.
+#ifdef FFTWPP_THREADS
+constexpr bool HasThreads = true;
+#else
+constexpr bool HasThreads = false;
+#endif
+
+// Initialise the threaded fftw3 libraries. This is done automatically by
+// PlanWithThreads, and need only be called directly to control when it is
+// done.
+inline void InitThreads() {
+#ifdef FFTWPP_THREADS
+  static const auto initialised = [] {
+    return fftwf_init_threads() && fftw_init_threads() && fftwl_init_threads();
+  }();
+  assert(initialised);
+#endif
+}
+
+// Set the number of threads used by plans made after the call. Without the
+// threaded libraries, only a single thread is possible.
+inline void PlanWithThreads(int threads) {
+#ifdef FFTWPP_THREADS
+  InitThreads();
+  auto lock = std::scoped_lock(PlannerMutex());
+  fftwf_plan_with_nthreads(threads);
+  fftw_plan_with_nthreads(threads);
+  fftwl_plan_with_nthreads(threads);
+#else
+  assert(threads == 1);
+#endif
+}
+
+// Return the number of threads used by newly made plans.
+inline int PlannerThreads() {
+#ifdef FFTWPP_THREADS
+  InitThreads();
+  auto lock = std::scoped_lock(PlannerMutex());
+  return fftw_planner_nthreads();
+#else
+  return 1;
+#endif
+}
+
+// Run the parallel loops of threaded fftw3 plans on the given pool, so that
+// their threads can be pinned or otherwise controlled. The workers take on
+// the floating-point state of the calling thread, so that flushing of
+// subnormals applies to them. A null pool restores fftw3's own threads.
+// This requires fftw3 version 3.3.9 or later, and should be done before
+// plans are made.
+inline void UseThreadPool(ThreadPool* pool) {
+#ifdef FFTWPP_THREADS
+  InitThreads();
+  using Loop = void (*)(void* (*)(char*), char*, std::size_t, int, void*);
+  auto loop = Loop{nullptr};
+  if (pool) {
+    loop = [](void* (*work)(char*), char* jobdata, std::size_t elsize,
+              int njobs, void* data) {
+      auto caller = DenormalState();
+      static_cast<ThreadPool*>(data)->ParallelFor(njobs, [&](int i) {
+        auto state = ScopedDenormalState(caller);
+        work(jobdata + elsize * i);
+      });
+    };
+  }
+  auto lock = std::scoped_lock(PlannerMutex());
+  fftwf_threads_set_callback(loop, pool);
+  fftw_threads_set_callback(loop, pool);
+  fftwl_threads_set_callback(loop, pool);
+#else
+  assert(pool == nullptr);
+#endif
+}
+
+}  // namespace FFTWpp
+
+#endif  // FFTWPP_THREADS_GUARD_H
@@ -0,0 +1,74 @@
+#ifndef FFTWPP_TIMING_GUARD_H
+#define FFTWPP_TIMING_GUARD_H
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <type_traits>
+#include <vector>
+
+#include "NumericConcepts/Numeric.hpp"
+
+namespace FFTWpp {
+
+// Return the seconds elapsed since the given time.
+inline double Seconds(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                       start)
+      .count();
+}
+
+// Return the median time of repeated executes of the plan. After a first
+// untimed execute, at least three are timed, continuing until the given
+// number of seconds has been spent.
+template <typename PlanType>
+double ExecuteTime(PlanType& plan, double seconds) {
+  plan.Execute();
+  auto times = std::vector<double>();
+  auto total = 0.0;
+  while (times.size() < 3 || (total < seconds && times.size() < 1000)) {
+    auto start = std::chrono::steady_clock::now();
+    plan.Execute();
+    times.push_back(Seconds(start));
+    total += times.back();
+  }
+  auto middle = times.begin() + times.size() / 2;
+  std::ranges::nth_element(times, middle);
+  return *middle;
+}
+
+// Return the nominal floating-point operations of an execute of the plan,
+// following the convention of benchFFT: 5 N log2(N) for a complex transform
+// of N points and half that for a real transform, for each transform.
+template <typename PlanType>
+double NominalFlops(PlanType& plan) {
+  using InType = std::remove_pointer_t<decltype(plan.InData())>;
+  using OutType = std::remove_pointer_t<decltype(plan.OutData())>;
+  constexpr auto complex = NumericConcepts::Complex<InType> &&
+                           NumericConcepts::Complex<OutType>;
+  const auto& layout =
+      NumericConcepts::Real<InType> ? plan.InLayout() : plan.OutLayout();
+  auto n = 1.0;
+  for (auto dimension : layout.N()) n *= dimension;
+  return (complex ? 5.0 : 2.5) * n * std::log2(n) * layout.HowMany();
+}
+
+// Return the bytes of the elements read and written by an execute of the
+// plan, counting each element of the input and output once. This is the
+// least memory traffic of a transform whose data do not fit in cache.
+template <typename PlanType>
+double TouchedBytes(PlanType& plan) {
+  using InType = std::remove_pointer_t<decltype(plan.InData())>;
+  using OutType = std::remove_pointer_t<decltype(plan.OutData())>;
+  auto elements = [](const auto& layout) {
+    auto n = 1.0;
+    for (auto dimension : layout.N()) n *= dimension;
+    return n * layout.HowMany();
+  };
+  return elements(plan.InLayout()) * sizeof(InType) +
+         elements(plan.OutLayout()) * sizeof(OutType);
+}
+
+}  // namespace FFTWpp
+
+#endif  // FFTWPP_TIMING_GUARD_H
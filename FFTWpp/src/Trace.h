@@ -0,0 +1,294 @@
+#ifndef FFTWPP_TRACE_GUARD_H
+#define FFTWPP_TRACE_GUARD_H
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <ranges>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#endif
+
+namespace FFTWpp {
+
+// A span of time recorded by the tracer.
+struct TraceEvent {
+  const char* name;      // Static name of the event.
+  const char* category;  // Static category, such as "execute".
+  std::int64_t start;    // Start in nanoseconds since the tracer epoch.
+  std::int64_t duration;
+  std::array<char, 96> detail;  // Optional detail, such as a plan key.
+};
+
+// Records spans of planning, wisdom, execution and allocation for export
+// in the Chrome trace format, which Perfetto and chrome://tracing open.
+// Each thread records into its own fixed-size buffer without locking, and
+// events beyond a buffer's capacity are dropped and counted. Buffers are
+// made when tracing is enabled, and each thread claims one on its first
+// event without locking or allocating. When tracing is disabled, recording
+// costs a single relaxed atomic load.
+class Tracer {
+ public:
+  static Tracer& Get() {
+    static auto* tracer = new Tracer;
+    return *tracer;
+  }
+
+  // Start recording, with the given capacity in events of each thread's
+  // buffer, making unclaimed buffers for the given number of threads.
+  // Threads beyond these allocate their buffer on their first event.
+  // Buffers already made keep their capacity.
+  void Enable(std::size_t capacity = 1 << 12,
+              int threads = static_cast<int>(
+                  std::max(1u, std::thread::hardware_concurrency()))) {
+    {
+      auto lock = std::scoped_lock(_mutex);
+      _capacity = capacity;
+      for (auto i = _spares.load(); i < threads; i++) Push(NewBuffer());
+    }
+    _enabled.store(true, std::memory_order_relaxed);
+  }
+
+  void Disable() { _enabled.store(false, std::memory_order_relaxed); }
+
+  bool Enabled() const { return _enabled.load(std::memory_order_relaxed); }
+
+  // Mutex guarding the registered buffers, which is held across a fork.
+  std::mutex& Mutex() { return _mutex; }
+
+  // Return the nanoseconds since the tracer epoch.
+  std::int64_t Now() const {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now() - _epoch)
+        .count();
+  }
+
+  // Record an event on the calling thread.
+  void Record(const TraceEvent& event) {
+    auto& buffer = ThreadBuffer();
+    auto count = buffer.count.load(std::memory_order_relaxed);
+    if (count == buffer.events.size()) {
+      buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+    buffer.events[count] = event;
+    buffer.count.store(count + 1, std::memory_order_release);
+  }
+
+  // Return the number of events recorded and dropped over all threads.
+  std::size_t Recorded() {
+    auto recorded = std::size_t{0};
+    ForEachBuffer([&](const auto& buffer) {
+      recorded += buffer.count.load(std::memory_order_acquire);
+    });
+    return recorded;
+  }
+
+  std::size_t Dropped() {
+    auto dropped = std::size_t{0};
+    ForEachBuffer([&](const auto& buffer) {
+      dropped += buffer.dropped.load(std::memory_order_relaxed);
+    });
+    return dropped;
+  }
+
+  // Discard the recorded events. This must not be called while events are
+  // being recorded.
+  void Clear() {
+    ForEachBuffer([](auto& buffer) {
+      buffer.count.store(0, std::memory_order_release);
+      buffer.dropped.store(0, std::memory_order_relaxed);
+    });
+  }
+
+  // Write the recorded events as Chrome trace JSON. Events still being
+  // recorded by other threads are not included.
+  void Write(std::ostream& stream) {
+    auto pid = ProcessId();
+    auto first = true;
+    auto separator = [&]() {
+      stream << (first ? "\n" : ",\n");
+      first = false;
+    };
+    stream << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    ForEachBuffer([&](const auto& buffer) {
+      auto thread = buffer.thread.load(std::memory_order_relaxed);
+      separator();
+      stream << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << pid
+             << ",\"tid\":" << thread
+             << ",\"args\":{\"name\":\"FFTWpp thread " << thread
+             << "\"}}";
+      auto count = buffer.count.load(std::memory_order_acquire);
+      for (const auto& event : buffer.events | std::views::take(count)) {
+        separator();
+        stream << "{\"name\":\"" << Escaped(event.name) << "\",\"cat\":\""
+               << Escaped(event.category) << "\",\"ph\":\"X\",\"ts\":"
+               << Microseconds(event.start)
+               << ",\"dur\":" << Microseconds(event.duration)
+               << ",\"pid\":" << pid << ",\"tid\":" << thread;
+        if (event.detail[0] != '\0') {
+          stream << ",\"args\":{\"detail\":\"" << Escaped(event.detail.data())
+                 << "\"}";
+        }
+        stream << "}";
+      }
+    });
+    stream << "\n]}\n";
+  }
+
+  // Write the trace to a file, returning true on success.
+  bool Write(const std::string& filename) {
+    auto file = std::ofstream(filename);
+    Write(file);
+    return static_cast<bool>(file);
+  }
+
+ private:
+  struct Buffer {
+    explicit Buffer(std::size_t capacity) : events(capacity) {}
+    std::vector<TraceEvent> events;
+    std::atomic<std::size_t> count = 0;
+    std::atomic<std::size_t> dropped = 0;
+    std::atomic<int> thread = -1;  // Index of the thread, or -1 if unclaimed.
+    Buffer* next = nullptr;        // Next unclaimed buffer.
+  };
+
+  std::atomic<bool> _enabled = false;
+  std::size_t _capacity = 1 << 12;
+  std::chrono::steady_clock::time_point _epoch =
+      std::chrono::steady_clock::now();
+  std::mutex _mutex;
+  std::vector<std::unique_ptr<Buffer>> _buffers;
+  std::atomic<Buffer*> _unclaimed = nullptr;
+  std::atomic<int> _spares = 0;
+  std::atomic<int> _threads = 0;
+
+  // Return a new buffer, registered so that its events are written. The
+  // mutex must be held.
+  Buffer* NewBuffer() {
+    _buffers.push_back(std::make_unique<Buffer>(_capacity));
+    return _buffers.back().get();
+  }
+
+  // Add a buffer to the stack of unclaimed buffers.
+  void Push(Buffer* buffer) {
+    buffer->next = _unclaimed.load(std::memory_order_relaxed);
+    while (!_unclaimed.compare_exchange_weak(buffer->next, buffer,
+                                             std::memory_order_release,
+                                             std::memory_order_relaxed)) {
+    }
+    _spares.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  // Claim an unclaimed buffer, returning null if there are none. Claimed
+  // buffers never return to the stack, so a compare-exchange cannot see a
+  // reused head.
+  Buffer* Pop() {
+    auto buffer = _unclaimed.load(std::memory_order_acquire);
+    while (buffer && !_unclaimed.compare_exchange_weak(
+                         buffer, buffer->next, std::memory_order_acquire)) {
+    }
+    if (buffer) _spares.fetch_sub(1, std::memory_order_relaxed);
+    return buffer;
+  }
+
+  // Return the calling thread's buffer, claiming one on first use and
+  // allocating it only if none were made by Enable. Buffers are kept after
+  // their threads exit so that their events can still be written.
+  Buffer& ThreadBuffer() {
+    thread_local auto buffer = static_cast<Buffer*>(nullptr);
+    if (!buffer) {
+      buffer = Pop();
+      if (!buffer) {
+        auto lock = std::scoped_lock(_mutex);
+        buffer = NewBuffer();
+      }
+      buffer->thread.store(_threads.fetch_add(1, std::memory_order_relaxed),
+                           std::memory_order_release);
+    }
+    return *buffer;
+  }
+
+  // Call the function for each claimed buffer.
+  template <typename F>
+  void ForEachBuffer(F&& f) {
+    auto lock = std::scoped_lock(_mutex);
+    for (auto& buffer : _buffers) {
+      if (buffer->thread.load(std::memory_order_acquire) >= 0) f(*buffer);
+    }
+  }
+
+  static int ProcessId() {
+#if defined(__unix__) || defined(__APPLE__)
+    return static_cast<int>(getpid());
+#else
+    return 0;
+#endif
+  }
+
+  static double Microseconds(std::int64_t nanoseconds) {
+    return static_cast<double>(nanoseconds) * 1e-3;
+  }
+
+  static std::string Escaped(std::string_view text) {
+    auto escaped = std::string();
+    for (auto c : text) {
+      if (c == '"' || c == '\\') escaped += '\\';
+      if (static_cast<unsigned char>(c) >= 0x20) escaped += c;
+    }
+    return escaped;
+  }
+};
+
+// Records the lifetime of the object as a span if tracing is enabled.
+class ScopedTrace {
+ public:
+  ScopedTrace(const char* name, const char* category)
+      : _active{Tracer::Get().Enabled()} {
+    if (!_active) return;
+    _event.name = name;
+    _event.category = category;
+    _event.detail[0] = '\0';
+    _event.start = Tracer::Get().Now();
+  }
+
+  ScopedTrace(const ScopedTrace&) = delete;
+  ScopedTrace& operator=(const ScopedTrace&) = delete;
+
+  ~ScopedTrace() {
+    if (!_active) return;
+    _event.duration = Tracer::Get().Now() - _event.start;
+    Tracer::Get().Record(_event);
+  }
+
+  // Returns true if the span is being recorded.
+  bool Active() const { return _active; }
+
+  // Set the detail of the span, truncating it to fit.
+  void Detail(std::string_view detail) {
+    if (!_active) return;
+    auto size = std::min(detail.size(), _event.detail.size() - 1);
+    std::ranges::copy_n(detail.begin(), size, _event.detail.begin());
+    _event.detail[size] = '\0';
+  }
+
+ private:
+  bool _active;
+  TraceEvent _event;
+};
+
+}  // namespace FFTWpp
+
+#endif  // FFTWPP_TRACE_GUARD_H
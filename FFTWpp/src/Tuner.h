@@ -0,0 +1,363 @@
+#ifndef FFTWPP_TUNER_GUARD_H
+#define FFTWPP_TUNER_GUARD_H
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <complex>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <ranges>
+#include <span>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "Core.h"
+#include "Key.h"
+#include "NumericConcepts/Numeric.hpp"
+#include "NumericConcepts/Ranges.hpp"
+#include "Options.h"
+#include "Plan.h"
+#include "ThreadPool.h"
+#include "Threads.h"
+#include "Timing.h"
+#include "Utility.h"
+#include "Views.h"
+#include "Wisdom.h"
+#include "fftw3.h"
+
+namespace FFTWpp {
+
+// Configuration for performing a batch of transforms.
+struct Tuning {
+  Flag flag = Estimate;  // Planning flag.
+  int threads = 1;       // Threads used by fftw3 within the plan.
+  int splits = 1;        // Sub-batches executed in parallel on a ThreadPool.
+  bool inPlace = false;  // Copy input to output and transform in-place.
+  double planTime = 0;     // Measured planning time in seconds.
+  double executeTime = 0;  // Measured time per execute in seconds.
+
+  // Expected time for planning and the given number of executions.
+  auto Cost(long executions) const {
+    return planTime + static_cast<double>(executions) * executeTime;
+  }
+};
+
+namespace Ranges {
+
+// Plan performing a batch of transforms using the given Tuning.
+template <NumericConcepts::RealOrComplexWritableRange InView,
+          NumericConcepts::RealOrComplexWritableRange OutView>
+requires NumericConcepts::SameRangePrecision<InView, OutView>
+class TunedPlan {
+  using InType = std::ranges::range_value_t<InView>;
+  using OutType = std::ranges::range_value_t<OutView>;
+  using PartPlan = Plan<std::span<InType>, std::span<OutType>>;
+
+ public:
+  // Constructor given the views, tuning and any direction or kinds.
+  template <typename... Args>
+  TunedPlan(View<InView> in, View<OutView> out, Tuning tuning, Args... args)
+      : _in{in},
+        _out{out},
+        _tuning{tuning},
+        _inPart{Part(in, tuning.splits)},
+        _outPart{Part(out, tuning.splits)} {
+    assert(CanSplit(_in, _out, _tuning.splits));
+    assert(!_tuning.inPlace || CanTransformInPlace(_in, _out));
+    auto threads = PlannerThreads();
+    PlanWithThreads(_tuning.threads);
+    _plan = std::make_unique<PartPlan>(
+        View(std::span(InData(), _inPart.size()), _inPart),
+        View(std::span(_out.DataPointer(), _outPart.size()), _outPart),
+        _tuning.flag, args...);
+    PlanWithThreads(threads);
+    if (_tuning.splits > 1) {
+      _pool = std::make_unique<ThreadPool>(_tuning.splits - 1);
+      // Parts aligned differently from the first need the unaligned plan,
+      // which is made now rather than by a worker during an execute.
+      if (!PartsAligned()) _plan->PrepareUnaligned();
+    }
+  }
+
+  // Return the tuning used.
+  const auto& GetTuning() const { return _tuning; }
+
+  // Normalisation factor for inverse transformations.
+  auto Normalisation() const { return _plan->Normalisation(); }
+
+  // Execute the plan.
+  void Execute() {
+    if constexpr (std::same_as<InType, OutType>) {
+      if (_tuning.inPlace) std::ranges::copy(_in, _out.begin());
+    }
+    if (_tuning.splits == 1) {
+      _plan->Execute();
+      return;
+    }
+    auto in = InData();
+    auto out = _out.DataPointer();
+    auto inStep = _inPart.HowMany() * _inPart.Dist();
+    auto outStep = _outPart.HowMany() * _outPart.Dist();
+    _pool->ParallelFor(_tuning.splits, [&](int k) {
+      _plan->Execute(std::span(in + k * inStep, _inPart.size()),
+                     std::span(out + k * outStep, _outPart.size()));
+    });
+  }
+
+  // Returns true if the batch can be split into the given number of parts.
+  static bool CanSplit(const Layout& in, const Layout& out, int splits) {
+    auto contiguous = [](const Layout& layout) {
+      auto size =
+          std::ranges::fold_left_first(layout.Embed(), std::multiplies<>())
+              .value();
+      return layout.Stride() == 1 && layout.Dist() == size;
+    };
+    if (splits == 1) return true;
+    return in.HowMany() % splits == 0 && contiguous(in) && contiguous(out);
+  }
+
+  // Returns true if the transform can be done in-place on the output.
+  static bool CanTransformInPlace(const Layout& in, const Layout& out) {
+    return std::same_as<InType, OutType> && in == out;
+  }
+
+ private:
+  View<InView> _in;
+  View<OutView> _out;
+  Tuning _tuning;
+  Layout _inPart;
+  Layout _outPart;
+  std::unique_ptr<PartPlan> _plan;
+  std::unique_ptr<ThreadPool> _pool;
+
+  // Layout of a single part of the split batch.
+  static Layout Part(const Layout& layout, int splits) {
+    return Layout(layout.Rank(), layout.N(), layout.HowMany() / splits,
+                  layout.Embed(), layout.Stride(), layout.Dist());
+  }
+
+  // Returns true if every part has the alignment of the first.
+  bool PartsAligned() {
+    auto in = InData();
+    auto out = _out.DataPointer();
+    auto inStep = _inPart.HowMany() * _inPart.Dist();
+    auto outStep = _outPart.HowMany() * _outPart.Dist();
+    for (auto k = 1; k < _tuning.splits; k++) {
+      if (AlignmentOf(in + k * inStep) != AlignmentOf(in) ||
+          AlignmentOf(out + k * outStep) != AlignmentOf(out)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Data transformed by the plan.
+  InType* InData() {
+    if constexpr (std::same_as<InType, OutType>) {
+      if (_tuning.inPlace) return _out.DataPointer();
+    }
+    return _in.DataPointer();
+  }
+};
+
+}  // namespace Ranges
+
+// Selects the planning flag, thread count, decomposition and placement for
+// batches of transforms by benchmarking the candidates on scratch arrays.
+// The total cost of planning and the expected number of executions is
+// minimised, so that costly planning is only chosen when it pays for
+// itself. Flags are taken in order of increasing rigour, and a flag is not
+// measured once a lower bound on its planning time exceeds the best total.
+// Measurements are kept by plan key, so that later queries, including
+// those for other numbers of executions, measure only the flags they need
+// that have not been measured before. Results can be saved alongside the
+// wisdom generated.
+class Tuner {
+ public:
+  // Minimum time in seconds spent timing the executes of each candidate.
+  static constexpr double TimingSeconds = 0.02;
+
+  // Planning with a flag that measures times several algorithms, each for
+  // at least one execute, and so is taken to cost at least this many
+  // executes of the fastest plan measured before it.
+  static constexpr double MeasuredExecutes = 8;
+
+  // Construct a tuner, optionally loading tunings and wisdom saved with the
+  // given base filename, that selects among the given flags.
+  Tuner(std::string filename = "",
+        int maxThreads = std::thread::hardware_concurrency(),
+        std::vector<Flag> flags = {Estimate, Measure, Patient})
+      : _filename{filename},
+        _maxThreads{std::max(maxThreads, 1)},
+        _flags{std::move(flags)} {
+    assert(!_flags.empty());
+    if (!_filename.empty()) Load();
+  }
+
+  // Return a tuner that selects only among the given flags, planning with
+  // a single thread and executing out-of-place in one batch.
+  static Tuner FlagsOnly(std::vector<Flag> flags) {
+    auto tuner = Tuner("", 1, std::move(flags));
+    tuner._flagsOnly = true;
+    return tuner;
+  }
+
+  // Save the tunings and wisdom for all precisions.
+  void Save() const {
+    assert(!_filename.empty());
+    auto file = std::ofstream(_filename + ".tuning");
+    for (const auto& [key, tunings] : _tunings) {
+      for (const auto& tuning : tunings) {
+        file << key << " " << static_cast<unsigned>(tuning.flag) << " "
+             << tuning.threads << " " << tuning.splits << " "
+             << tuning.inPlace << " " << tuning.planTime << " "
+             << tuning.executeTime << "\n";
+      }
+    }
+    ExportWisdomFiles(_filename);
+  }
+
+  // Return the tuning for the given layouts and number of executions.
+  // The remaining arguments are the direction or kinds as needed.
+  template <NumericConcepts::RealOrComplex InType,
+            NumericConcepts::RealOrComplex OutType, typename... Args>
+  requires NumericConcepts::SamePrecision<InType, OutType>
+  Tuning Tune(Ranges::Layout inLayout, Ranges::Layout outLayout,
+              long executions, Args... args) {
+    assert(executions >= 0);
+    auto& measured = _tunings[PlanKey<InType, OutType>(
+        inLayout, outLayout, KeyOptions(args...))];
+    using TunedPlan =
+        Ranges::TunedPlan<std::ranges::ref_view<vector<InType>>,
+                          std::ranges::ref_view<vector<OutType>>>;
+    for (auto flag : _flags) {
+      if (std::ranges::find(measured, flag, &Tuning::flag) != measured.end()) {
+        continue;
+      }
+      if (!measured.empty() &&
+          PlanTimeBound(measured, flag) >=
+              Best(measured, executions).Cost(executions)) {
+        break;
+      }
+      auto in = vector<InType>(inLayout.size());
+      auto out = vector<OutType>(outLayout.size());
+      for (auto tuning : Candidates<TunedPlan>(inLayout, outLayout)) {
+        tuning.flag = flag;
+        auto start = std::chrono::steady_clock::now();
+        auto plan = Ranges::TunedPlan(Ranges::View(in, inLayout),
+                                      Ranges::View(out, outLayout), tuning,
+                                      args...);
+        tuning.planTime = Seconds(start);
+        RandomiseValues(in);
+        tuning.executeTime = ExecuteTime(plan, TimingSeconds);
+        measured.push_back(tuning);
+      }
+      _measurements++;
+    }
+    return Best(measured, executions);
+  }
+
+  // Return the tunings measured for the given layouts.
+  template <NumericConcepts::RealOrComplex InType,
+            NumericConcepts::RealOrComplex OutType, typename... Args>
+  requires NumericConcepts::SamePrecision<InType, OutType>
+  std::vector<Tuning> Measured(Ranges::Layout inLayout,
+                               Ranges::Layout outLayout, Args... args) const {
+    auto it = _tunings.find(
+        PlanKey<InType, OutType>(inLayout, outLayout, KeyOptions(args...)));
+    return it == _tunings.end() ? std::vector<Tuning>{} : it->second;
+  }
+
+  // Returns the number of flags measured over all queries.
+  auto Measurements() const { return _measurements; }
+
+  // Tune the transform and return the plan it selects.
+  template <NumericConcepts::RealOrComplexWritableRange InView,
+            NumericConcepts::RealOrComplexWritableRange OutView,
+            typename... Args>
+  auto MakePlan(Ranges::View<InView> in, Ranges::View<OutView> out,
+                long executions, Args... args) {
+    using InType = std::ranges::range_value_t<InView>;
+    using OutType = std::ranges::range_value_t<OutView>;
+    auto tuning = Tune<InType, OutType>(in, out, executions, args...);
+    return Ranges::TunedPlan<InView, OutView>(in, out, tuning, args...);
+  }
+
+ private:
+  std::string _filename;
+  int _maxThreads;
+  std::vector<Flag> _flags;
+  bool _flagsOnly = false;
+  std::map<std::string, std::vector<Tuning>> _tunings;
+  long _measurements = 0;
+
+  static Tuning Best(const std::vector<Tuning>& tunings, long executions) {
+    return std::ranges::min(tunings, {}, [executions](const auto& tuning) {
+      return tuning.Cost(executions);
+    });
+  }
+
+  // Return a lower bound on the planning time with the flag given the
+  // tunings measured with less rigorous flags. Planning only gets slower
+  // with rigour, and flags that measure time the plans they consider.
+  static double PlanTimeBound(const std::vector<Tuning>& measured,
+                              Flag flag) {
+    auto fastest = std::ranges::min(measured, {}, &Tuning::executeTime);
+    auto bound = std::ranges::min(measured, {}, &Tuning::planTime).planTime;
+    if ((flag & (FFTW_ESTIMATE | FFTW_WISDOM_ONLY)) == 0) {
+      bound = std::max(bound, MeasuredExecutes * fastest.executeTime);
+    }
+    return bound;
+  }
+
+  // Load tunings and wisdom saved previously.
+  void Load() {
+    ImportWisdomFiles(_filename);
+    auto file = std::ifstream(_filename + ".tuning");
+    auto line = std::string();
+    while (std::getline(file, line)) {
+      auto stream = std::istringstream(line);
+      auto key = std::string();
+      auto flag = 0u;
+      auto tuning = Tuning{};
+      if (stream >> key >> flag >> tuning.threads >> tuning.splits >>
+          tuning.inPlace >> tuning.planTime >> tuning.executeTime) {
+        tuning.flag = Flag{flag};
+        _tunings[key].push_back(tuning);
+      }
+    }
+  }
+
+  // Candidate thread counts, decompositions and placements.
+  template <typename TunedPlan>
+  auto Candidates(const Ranges::Layout& in, const Ranges::Layout& out) const {
+    auto candidates = std::vector<Tuning>{Tuning{}};
+    if (_flagsOnly) return candidates;
+    for (auto threads = 2; threads <= _maxThreads; threads *= 2) {
+      if (HasThreads) {
+        candidates.push_back(Tuning{.threads = threads});
+      }
+      if (TunedPlan::CanSplit(in, out, threads)) {
+        candidates.push_back(Tuning{.splits = threads});
+      }
+    }
+    if (TunedPlan::CanTransformInPlace(in, out)) {
+      auto size = candidates.size();
+      for (auto i = std::size_t{0}; i < size; i++) {
+        auto tuning = candidates[i];
+        tuning.inPlace = true;
+        candidates.push_back(tuning);
+      }
+    }
+    return candidates;
+  }
+};
+
+}  // namespace FFTWpp
+
+#endif  // FFTWPP_TUNER_GUARD_H
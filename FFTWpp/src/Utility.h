@@ -2,6 +2,7 @@
 #define FFTWPP_UTILITY_GUARD_H
 
 #include <algorithm>
+#include <cmath>
 #include <complex>
 #include <random>
 #include <ranges>
@@ -9,6 +10,7 @@
 #include "Core.h"
 #include "NumericConcepts/Numeric.hpp"
 #include "NumericConcepts/Ranges.hpp"
+#include "Views.h"
 
 namespace FFTWpp {
 
@@ -42,6 +44,26 @@ auto DataSize(Dimensions... dimensions) {
   }
 }
 
+// Returns the size of in and out arrays for transforms with given
+// dimensions when the embed dimensions are padded.
+template <NumericConcepts::RealOrComplex InType,
+          NumericConcepts::RealOrComplex OutType, typename... Dimensions>
+requires(sizeof...(Dimensions) > 0) and (std::integral<Dimensions> && ...)
+auto DataSize(Ranges::Pad pad, Dimensions... dimensions) {
+  auto dims = std::vector{{static_cast<int>(dimensions)...}};
+  auto complexDims = dims;
+  if constexpr (!std::same_as<InType, OutType>) {
+    complexDims.back() = complexDims.back() / 2 + 1;
+  }
+  auto size = [pad](auto dims) {
+    return std::ranges::fold_left_first(Ranges::PaddedEmbed(pad, dims),
+                                        std::multiplies<>())
+        .value();
+  };
+  return std::pair(size(NumericConcepts::Real<InType> ? dims : complexDims),
+                   size(NumericConcepts::Real<OutType> ? dims : complexDims));
+}
+
 // Sets values within a range using a standard normal distribution.
 template <NumericConcepts::RealOrComplexWritableRange Range>
 void RandomiseValues(Range& range) {
@@ -74,6 +96,31 @@ auto CheckValues(Range&& in, Range&& copy, Scalar norm) {
       [](auto x) { return x < 1000 * std::numeric_limits<Real>::epsilon(); });
 }
 
+// Returns the root-mean-square difference of two ranges, once the second is
+// scaled by the given norm, relative to the root-mean-square of the first.
+// The ranges may differ in precision, and the sums are formed in long
+// double so that the error of a reference of higher precision is resolved.
+template <NumericConcepts::RealOrComplexRange Range1,
+          NumericConcepts::RealOrComplexRange Range2, typename Scalar>
+double RelativeError(Range1&& values, Range2&& reference, Scalar norm) {
+  auto widen = [](auto z) {
+    if constexpr (NumericConcepts::Complex<decltype(z)>) {
+      return std::complex<long double>(z);
+    } else {
+      return static_cast<long double>(z);
+    }
+  };
+  auto difference = 0.0L;
+  auto magnitude = 0.0L;
+  auto y = std::ranges::begin(reference);
+  for (auto x : values) {
+    difference += std::norm(widen(x) - widen(*y++) * widen(norm));
+    magnitude += std::norm(widen(x));
+  }
+  return magnitude > 0 ? static_cast<double>(std::sqrt(difference / magnitude))
+                       : static_cast<double>(std::sqrt(difference));
+}
+
 }  // namespace FFTWpp
 
 #endif  // FFTWPP_UTILITY_GUARD_H
\ No newline at end of file
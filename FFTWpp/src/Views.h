@@ -5,8 +5,10 @@
 #include <cassert>
 #include <complex>
 #include <concepts>
+#include <cstddef>
 #include <memory>
 #include <ranges>
+#include <utility>
 #include <vector>
 
 #include "Core.h"
@@ -16,8 +18,34 @@
 
 namespace FFTWpp {
 
+// Size in bytes of the padding used to avoid cache-set aliasing.
+constexpr std::size_t CacheLineBytes = 64;
+
 namespace Ranges {
 
+// Number of elements added to each embed dimension other than the first.
+// With power-of-two dimensions, the strides between rows and planes of an
+// array are often multiples of the cache size divided by its associativity,
+// so that the column passes of a transform repeatedly evict the same cache
+// sets. Padding the embed dimensions breaks this pattern.
+struct Pad {
+  int elements = 0;
+
+  // Padding of a cache line for the given element type.
+  template <NumericConcepts::RealOrComplex T>
+  static constexpr Pad CacheLine() {
+    return Pad{static_cast<int>(CacheLineBytes / sizeof(T))};
+  }
+};
+
+// Returns the given dimensions with all but the first padded.
+inline std::vector<int> PaddedEmbed(Pad pad, std::vector<int> n) {
+  for (auto& dimension : n | std::views::drop(1)) {
+    dimension += pad.elements;
+  }
+  return n;
+}
+
 class Layout {
  public:
   Layout() = default;
@@ -29,6 +57,16 @@ class Layout {
       : Layout(sizeof...(Dimensions), std::vector{dimensions...}, 1,
                std::vector{dimensions...}, 1, 0) {}
 
+  // Constructor for multi-dimensional transforms with padded embed
+  // dimensions.
+  template <typename... Dimensions>
+  requires(sizeof...(Dimensions) > 0) and (std::integral<Dimensions> && ...)
+  Layout(Pad pad, Dimensions... dimensions)
+      : Layout(sizeof...(Dimensions), std::vector{dimensions...}, 1,
+               PaddedEmbed(pad,
+                           std::vector{static_cast<int>(dimensions)...}),
+               1, 0) {}
+
   template <std::ranges::range R1, std::ranges::range R2>
   requires requires() {
     requires std::convertible_to<std::ranges::range_value_t<R1>, int>;
@@ -61,6 +99,50 @@ class Layout {
                .value_or(0);
   }
 
+  // Return the number of elements spanned by the data, from the first
+  // element of the first transform to the last element of the last.
+  auto Extent() const {
+    auto offset = std::ptrdiff_t{0};
+    auto scale = std::ptrdiff_t{1};
+    for (auto d = _rank - 1; d >= 0; d--) {
+      offset += (_n[d] - 1) * scale;
+      scale *= _embed[d];
+    }
+    return 1 + offset * _stride +
+           static_cast<std::ptrdiff_t>(_howMany - 1) * _dist;
+  }
+
+  // Return the number of elements transformed, excluding any padding.
+  auto Elements() const {
+    return static_cast<std::ptrdiff_t>(_howMany) *
+           std::ranges::fold_left(_n, std::ptrdiff_t{1}, std::multiplies<>());
+  }
+
+  // Return the offset of the element with the given index, counting the
+  // elements of each transform in row-major order and the transforms in
+  // turn.
+  auto Offset(std::ptrdiff_t index) const {
+    auto offset = std::ptrdiff_t{0};
+    auto scale = std::ptrdiff_t{1};
+    for (auto d = _rank - 1; d >= 0; d--) {
+      offset += (index % _n[d]) * scale;
+      index /= _n[d];
+      scale *= _embed[d];
+    }
+    return offset * _stride + index * _dist;
+  }
+
+  // Return a copy of the layout for a block within a larger array, whose
+  // views need only extend to the last element of the block.
+  Layout Block() const {
+    auto layout = *this;
+    layout._block = true;
+    return layout;
+  }
+
+  // Returns true if the layout is for a block within a larger array.
+  auto IsBlock() const { return _block; }
+
   bool operator==(const Layout&) const = default;
 
  private:
@@ -70,8 +152,15 @@ class Layout {
   std::vector<int> _embed;  // Size along each rank.
   int _stride;              // Offset between elements of the data.
   int _dist;                // Offset between the start of each transformation.
+  bool _block = false;      // Whether the data is a block of a larger array.
 };
 
+// Whether the data of a view used as an input may be overwritten by a
+// transform. Consumable data is scratch that plans are free to destroy,
+// while preserved data must be left unchanged. If unspecified, the choice
+// is left to the planning flags.
+enum class Ownership { Unspecified, Consumable, Preserved };
+
 template <NumericConcepts::RealOrComplexWritableView _View>
 class View : public std::ranges::view_interface<View<_View>>, public Layout {
   using std::ranges::view_interface<View<_View>>::size;
@@ -94,6 +183,14 @@ class View : public std::ranges::view_interface<View<_View>>, public Layout {
     assert(CheckSize());
   }
 
+  // Constructor given view and multi-dimensional transform parameters with
+  // padded embed dimensions.
+  template <typename... Dimensions>
+  requires(sizeof...(Dimensions) > 0) and
+          (std::convertible_to<Dimensions, int> && ...)
+  View(_View view, Pad pad, Dimensions... dimensions)
+      : View(view, Layout(pad, static_cast<int>(dimensions)...)) {}
+
   // Methods to inherit from view_interface.
   auto begin() { return _view.begin(); }
   auto end() { return _view.end(); }
@@ -101,18 +198,53 @@ class View : public std::ranges::view_interface<View<_View>>, public Layout {
   // Return appropriate fftw3 pointer to the start of the data.
   auto DataPointer() { return _view.data(); }
 
+  // Return copies of the view marked as consumable or preserved.
+  View Consumable() const {
+    auto view = *this;
+    view._ownership = Ownership::Consumable;
+    return view;
+  }
+
+  View Preserved() const {
+    auto view = *this;
+    view._ownership = Ownership::Preserved;
+    return view;
+  }
+
+  // Return the ownership of the data.
+  auto DataOwnership() const { return _ownership; }
+
  private:
   // Store view to the data.
   _View _view;
-
-  // Check the dimensions are consistent.
-  auto CheckSize() const { return _view.size() == Layout::size(); }
+  Ownership _ownership = Ownership::Unspecified;
+
+  // Check the view has the storage size of the layout. A view of a block
+  // within a larger array need only extend to its last element.
+  auto CheckSize() const {
+    if (IsBlock()) {
+      return std::cmp_greater_equal(_view.size(), Layout::Extent());
+    }
+    return std::cmp_equal(_view.size(), Layout::size());
+  }
 };
 
 // Deduction guide to allow range arguments.
 template <std::ranges::range R, typename... Args>
 View(R&&, Args...) -> View<std::ranges::views::all_t<R>>;
 
+// Returns a zero-initialised array with the storage size of the layout.
+template <NumericConcepts::RealOrComplex T>
+auto Allocate(const Layout& layout) {
+  return vector<T>(layout.size());
+}
+
+// As above, with the array's memory attributed to the given tag.
+template <NumericConcepts::RealOrComplex T>
+auto Allocate(const Layout& layout, const char* tag) {
+  return vector<T>(layout.size(), Allocator<T>(tag));
+}
+
 }  // namespace Ranges
 
 }  // namespace FFTWpp
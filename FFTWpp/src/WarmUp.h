@@ -0,0 +1,258 @@
+#ifndef FFTWPP_WARMUP_GUARD_H
+#define FFTWPP_WARMUP_GUARD_H
+
+#include <algorithm>
+#include <chrono>
+#include <complex>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <optional>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "Advisor.h"
+#include "Options.h"
+#include "PlanCache.h"
+#include "ThreadPool.h"
+#include "Timing.h"
+#include "Wisdom.h"
+
+namespace FFTWpp {
+
+// A transform listed within a warm-up manifest. Each line of a manifest
+// has the form
+//
+//   transform precision dimensions howMany arrangement flag [options]
+//
+// for example "c2c double 64x64 16 contiguous measure forward" or
+// "r2r float 32 8 padded patient redft10". The transform is c2c, r2c, c2r
+// or r2r, the precision is float, double or longdouble, and the dimensions
+// are the logical sizes separated by "x". The arrangement is contiguous,
+// interleaved or padded, and the flag is estimate, measure, patient,
+// exhaustive or wisdomonly. C2C transforms take a direction of forward or
+// backward, and R2R transforms take one or more kinds such as redft10.
+// Blank lines and lines starting with "#" are ignored.
+struct ManifestEntry {
+  std::string line{};
+  std::string transform{};
+  std::string precision{};
+  std::vector<int> n{};
+  int howMany = 1;
+  Arrangement arrangement = Arrangement::Contiguous;
+  Flag flag = Measure;
+  Direction direction = Forward;
+  std::vector<RealKind> kinds{};
+};
+
+// Parse a line of a manifest, returning nothing if it is invalid.
+inline std::optional<ManifestEntry> ParseManifestLine(const std::string& line) {
+  static const auto arrangements = std::map<std::string, Arrangement>{
+      {"contiguous", Arrangement::Contiguous},
+      {"interleaved", Arrangement::Interleaved},
+      {"padded", Arrangement::Padded}};
+  static const auto flags = std::map<std::string, Flag>{
+      {"estimate", Estimate},     {"measure", Measure},
+      {"patient", Patient},       {"exhaustive", Exhaustive},
+      {"wisdomonly", WisdomOnly}};
+  static const auto kinds = std::map<std::string, RealKind>{
+      {"r2hc", R2HC},       {"hc2r", HC2R},       {"dht", DHT},
+      {"redft00", REDFT00}, {"redft01", REDFT01}, {"redft10", REDFT10},
+      {"redft11", REDFT11}, {"rodft00", RODFT00}, {"rodft01", RODFT01},
+      {"rodft10", RODFT10}, {"rodft11", RODFT11}};
+
+  auto entry = ManifestEntry{.line = line};
+  auto stream = std::istringstream(line);
+  auto dimensions = std::string();
+  auto arrangement = std::string();
+  auto flag = std::string();
+  if (!(stream >> entry.transform >> entry.precision >> dimensions >>
+        entry.howMany >> arrangement >> flag)) {
+    return std::nullopt;
+  }
+  auto dimension = std::istringstream(dimensions);
+  for (auto token = std::string(); std::getline(dimension, token, 'x');) {
+    try {
+      entry.n.push_back(std::stoi(token));
+    } catch (...) {
+      return std::nullopt;
+    }
+  }
+  if (entry.n.empty() || std::ranges::any_of(entry.n, [](auto n) {
+        return n <= 0;
+      })) {
+    return std::nullopt;
+  }
+  if (entry.howMany <= 0 || !arrangements.contains(arrangement) ||
+      !flags.contains(flag)) {
+    return std::nullopt;
+  }
+  entry.arrangement = arrangements.at(arrangement);
+  entry.flag = flags.at(flag);
+
+  auto options = std::vector<std::string>();
+  for (auto option = std::string(); stream >> option;) {
+    options.push_back(option);
+  }
+  if (entry.transform == "c2c") {
+    if (options.size() != 1) return std::nullopt;
+    if (options.front() == "forward") {
+      entry.direction = Forward;
+    } else if (options.front() == "backward") {
+      entry.direction = Backward;
+    } else {
+      return std::nullopt;
+    }
+  } else if (entry.transform == "r2r") {
+    if (options.empty() || options.size() > entry.n.size()) {
+      return std::nullopt;
+    }
+    for (const auto& option : options) {
+      if (!kinds.contains(option)) return std::nullopt;
+      entry.kinds.push_back(kinds.at(option));
+    }
+  } else if (entry.transform != "r2c" && entry.transform != "c2r") {
+    return std::nullopt;
+  } else if (!options.empty()) {
+    return std::nullopt;
+  }
+  if (entry.precision != "float" && entry.precision != "double" &&
+      entry.precision != "longdouble") {
+    return std::nullopt;
+  }
+  return entry;
+}
+
+// Readiness of a plan listed in a manifest.
+struct PlanReadiness {
+  std::string line{};  // Line of the manifest.
+  std::string key{};   // Key of the plan within the cache.
+  bool ready = false;
+  double planTime = 0;  // Time in seconds to obtain the plan.
+  double warmTime = 0;  // Time in seconds of the warm-up executes.
+  std::string error{};
+};
+
+// Results of a warm-up.
+struct WarmUpReport {
+  double totalTime = 0;
+  std::vector<PlanReadiness> plans;
+
+  // Returns true if every plan is ready.
+  bool Ready() const {
+    return std::ranges::all_of(plans, [](const auto& plan) {
+      return plan.ready;
+    });
+  }
+};
+
+// Settings for a warm-up.
+struct WarmUpOptions {
+  std::string wisdom{};          // Base name of wisdom files to import.
+  int executes = 3;              // Warm-up executes of each plan.
+  ThreadPool* pool = nullptr;    // Pool used for the warm-up executes.
+};
+
+// Make the plan for a manifest entry within the cache, returning a function
+// that executes it on its scratch arrays, or an empty function if the plan
+// cannot be made, as with wisdomonly and no wisdom.
+template <NumericConcepts::Real Real>
+std::function<void()> CachePlan(const ManifestEntry& entry, PlanCache& cache,
+                                std::string& key) {
+  using Complex = std::complex<Real>;
+  auto make = [&]<typename InType, typename OutType>(auto... args) {
+    auto [in, out] = Ranges::Arrange<InType, OutType>(entry.arrangement,
+                                                      entry.n, entry.howMany);
+    auto plan = cache.Get<InType, OutType>(in, out, entry.flag, args...);
+    key = plan->Key();
+    if (plan->IsNull()) return std::function<void()>();
+    return std::function<void()>([plan]() { plan->Execute(); });
+  };
+  if (entry.transform == "c2c") {
+    return make.template operator()<Complex, Complex>(entry.direction);
+  }
+  if (entry.transform == "r2c") {
+    return make.template operator()<Real, Complex>();
+  }
+  if (entry.transform == "c2r") {
+    return make.template operator()<Complex, Real>();
+  }
+  return make.template operator()<Real, Real>(entry.kinds);
+}
+
+// Prepare the plans listed in a manifest at start-up. Wisdom is imported,
+// the plans are made into the cache on scratch arrays, and each is executed
+// a few times to warm its internal tables. Planning is done in turn as the
+// fftw3 planner is not thread-safe, but the warm-up executes are shared
+// between the workers of the pool if one is given.
+inline WarmUpReport WarmUp(const std::string& manifest, PlanCache& cache,
+                           const WarmUpOptions& options = {}) {
+  auto start = std::chrono::steady_clock::now();
+  auto report = WarmUpReport{};
+  if (!options.wisdom.empty()) ImportWisdomFiles(options.wisdom);
+
+  auto file = std::ifstream(manifest);
+  auto executes = std::vector<std::function<void()>>();
+  auto keys = std::set<std::string>();
+  for (auto line = std::string(); std::getline(file, line);) {
+    auto first = line.find_first_not_of(" \t");
+    if (first == std::string::npos || line[first] == '#') continue;
+    auto readiness = PlanReadiness{.line = line};
+    auto entry = ParseManifestLine(line);
+    if (!entry) {
+      readiness.error = "invalid manifest line";
+      report.plans.push_back(readiness);
+      executes.emplace_back();
+      continue;
+    }
+    auto planStart = std::chrono::steady_clock::now();
+    if (entry->precision == "float") {
+      executes.push_back(CachePlan<float>(*entry, cache, readiness.key));
+    } else if (entry->precision == "double") {
+      executes.push_back(CachePlan<double>(*entry, cache, readiness.key));
+    } else {
+      executes.push_back(
+          CachePlan<long double>(*entry, cache, readiness.key));
+    }
+    readiness.planTime = Seconds(planStart);
+    if (!executes.back()) {
+      readiness.error = "cannot make plan";
+      report.plans.push_back(readiness);
+      continue;
+    }
+    // Repeated entries share a plan, whose scratch arrays must not be
+    // written by two threads at once, so it is only warmed once.
+    if (!keys.insert(readiness.key).second) {
+      executes.back() = nullptr;
+      readiness.ready = true;
+    }
+    report.plans.push_back(readiness);
+  }
+  if (!file.is_open()) {
+    report.plans.push_back(
+        PlanReadiness{.line = manifest, .error = "cannot open manifest"});
+    executes.emplace_back();
+  }
+
+  auto warm = [&](int i) {
+    if (!executes[i]) return;
+    auto warmStart = std::chrono::steady_clock::now();
+    for (auto j = 0; j < options.executes; j++) executes[i]();
+    report.plans[i].warmTime = Seconds(warmStart);
+    report.plans[i].ready = true;
+  };
+  auto count = static_cast<int>(executes.size());
+  if (options.pool) {
+    options.pool->ParallelFor(count, warm);
+  } else {
+    for (auto i = 0; i < count; i++) warm(i);
+  }
+  report.totalTime = Seconds(start);
+  return report;
+}
+
+}  // namespace FFTWpp
+
+#endif  // FFTWPP_WARMUP_GUARD_H
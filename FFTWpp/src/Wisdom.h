@@ -2,67 +2,169 @@
 #define FFTWPP_WISDOM_GUARD_H
 
 #include <cassert>
+#include <filesystem>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "NumericConcepts/Numeric.hpp"
 #include "NumericConcepts/Ranges.hpp"
 #include "Options.h"
 #include "Plan.h"
+#include "PlanCache.h"
+#include "Trace.h"
 #include "Views.h"
 #include "fftw3.h"
 
 namespace FFTWpp {
 
-void ExportWisdom(const std::string& filename) {
-  int io = fftw_export_wisdom_to_filename(filename.c_str());
-  assert(io == 0);
+// Export the accumulated wisdom for the given precision to a file,
+// returning true on success.
+template <NumericConcepts::Real Real = double>
+bool ExportWisdom(const std::string& filename) {
+  auto trace = ScopedTrace("ExportWisdom", "wisdom");
+  trace.Detail(filename);
+  auto lock = std::scoped_lock(PlannerMutex());
+  if constexpr (NumericConcepts::Float<Real>) {
+    return fftwf_export_wisdom_to_filename(filename.c_str()) != 0;
+  }
+  if constexpr (NumericConcepts::Double<Real>) {
+    return fftw_export_wisdom_to_filename(filename.c_str()) != 0;
+  }
+  if constexpr (NumericConcepts::LongDouble<Real>) {
+    return fftwl_export_wisdom_to_filename(filename.c_str()) != 0;
+  }
 }
 
-void ImportWisdom(const std::string& filename) {
-  int io = fftw_import_wisdom_from_filename(filename.c_str());
-  assert(io == 0);
+// Import wisdom for the given precision from a file, returning true on
+// success.
+template <NumericConcepts::Real Real = double>
+bool ImportWisdom(const std::string& filename) {
+  auto trace = ScopedTrace("ImportWisdom", "wisdom");
+  trace.Detail(filename);
+  auto lock = std::scoped_lock(PlannerMutex());
+  if constexpr (NumericConcepts::Float<Real>) {
+    return fftwf_import_wisdom_from_filename(filename.c_str()) != 0;
+  }
+  if constexpr (NumericConcepts::Double<Real>) {
+    return fftw_import_wisdom_from_filename(filename.c_str()) != 0;
+  }
+  if constexpr (NumericConcepts::LongDouble<Real>) {
+    return fftwl_import_wisdom_from_filename(filename.c_str()) != 0;
+  }
 }
 
-void ForgetWisdom() { fftw_forget_wisdom(); }
+// Import wisdom for all precisions from files with the given base name and
+// the suffixes ".fftwf", ".fftw" and ".fftwl", skipping any that do not
+// exist. Returns the number of files imported.
+inline int ImportWisdomFiles(const std::string& filename) {
+  auto imported = 0;
+  for (auto [suffix, import] :
+       {std::pair{".fftwf", &ImportWisdom<float>},
+        std::pair{".fftw", &ImportWisdom<double>},
+        std::pair{".fftwl", &ImportWisdom<long double>}}) {
+    if (std::filesystem::exists(filename + suffix)) {
+      imported += import(filename + suffix);
+    }
+  }
+  return imported;
+}
+
+// Export wisdom for all precisions to files named as for ImportWisdomFiles.
+inline bool ExportWisdomFiles(const std::string& filename) {
+  return ExportWisdom<float>(filename + ".fftwf") &&
+         ExportWisdom<double>(filename + ".fftw") &&
+         ExportWisdom<long double>(filename + ".fftwl");
+}
 
+void ForgetWisdom() {
+  auto lock = std::scoped_lock(PlannerMutex());
+  fftw_forget_wisdom();
+}
+
+// Forget the accumulated wisdom for the given precision.
+template <NumericConcepts::Real Real>
+void ForgetWisdom() {
+  auto lock = std::scoped_lock(PlannerMutex());
+  if constexpr (NumericConcepts::Float<Real>) fftwf_forget_wisdom();
+  if constexpr (NumericConcepts::Double<Real>) fftw_forget_wisdom();
+  if constexpr (NumericConcepts::LongDouble<Real>) fftwl_forget_wisdom();
+}
+
+// Return the accumulated wisdom for the given precision as a string.
+template <NumericConcepts::Real Real = double>
+std::string ExportWisdomString() {
+  auto lock = std::scoped_lock(PlannerMutex());
+  auto wisdom = std::string();
+  auto take = [&](char* text, auto free) {
+    if (text == nullptr) return;
+    wisdom = text;
+    free(text);
+  };
+  if constexpr (NumericConcepts::Float<Real>) {
+    take(fftwf_export_wisdom_to_string(), fftwf_free);
+  }
+  if constexpr (NumericConcepts::Double<Real>) {
+    take(fftw_export_wisdom_to_string(), fftw_free);
+  }
+  if constexpr (NumericConcepts::LongDouble<Real>) {
+    take(fftwl_export_wisdom_to_string(), fftwl_free);
+  }
+  return wisdom;
+}
+
+// Import wisdom for the given precision from a string, returning true on
+// success.
+template <NumericConcepts::Real Real = double>
+bool ImportWisdomString(const std::string& wisdom) {
+  auto lock = std::scoped_lock(PlannerMutex());
+  if constexpr (NumericConcepts::Float<Real>) {
+    return fftwf_import_wisdom_from_string(wisdom.c_str()) != 0;
+  }
+  if constexpr (NumericConcepts::Double<Real>) {
+    return fftw_import_wisdom_from_string(wisdom.c_str()) != 0;
+  }
+  if constexpr (NumericConcepts::LongDouble<Real>) {
+    return fftwl_import_wisdom_from_string(wisdom.c_str()) != 0;
+  }
+}
+
+// Generate wisdom for the forward and backward transforms between arrays
+// with the given layouts. The plans made are returned, and can be used or
+// added to a PlanCache rather than discarded.
 template <NumericConcepts::RealOrComplex InType,
           NumericConcepts::RealOrComplex OutType>
 requires NumericConcepts::SamePrecision<InType, OutType>
-void GenerateWisdom(Ranges::Layout inLayout, Ranges::Layout outLayout,
+auto GenerateWisdom(Ranges::Layout inLayout, Ranges::Layout outLayout,
                     Flag flag) {
-  if (flag == Estimate) return;
-  auto in = vector<InType>(inLayout.size());
-  auto inView = Ranges::View(in, inLayout);
-  auto out = vector<OutType>(outLayout.size());
-  auto outView = Ranges::View(out, outLayout);
+  using Forward = Ranges::CachedPlan<InType, OutType>;
+  using Backward = Ranges::CachedPlan<OutType, InType>;
   if constexpr (NumericConcepts::Complex<InType> &&
                 NumericConcepts::Complex<OutType>) {
-    auto plan = Ranges::Plan(inView, outView, flag, Forward);
-    plan = Ranges::Plan(outView, inView, flag, Backward);
-  }
-  if constexpr ((NumericConcepts::Real<InType> &&
-                 NumericConcepts::Complex<OutType>) ||
-                (NumericConcepts::Complex<InType> &&
-                 NumericConcepts::Real<OutType>)) {
-    auto planForward = Ranges::Plan(inView, outView, flag);
-    auto planBackward = Ranges::Plan(outView, inView, flag);
+    return std::pair(
+        std::make_shared<Forward>(inLayout, outLayout, flag, FFTWpp::Forward),
+        std::make_shared<Backward>(outLayout, inLayout, flag,
+                                   FFTWpp::Backward));
+  } else {
+    return std::pair(std::make_shared<Forward>(inLayout, outLayout, flag),
+                     std::make_shared<Backward>(outLayout, inLayout, flag));
   }
 }
 
 template <NumericConcepts::Real InType, NumericConcepts::Real OutType>
 requires NumericConcepts::SamePrecision<InType, OutType>
-void GenerateWisdom(Ranges::Layout inLayout, Ranges::Layout outLayout,
+auto GenerateWisdom(Ranges::Layout inLayout, Ranges::Layout outLayout,
                     std::initializer_list<RealKind> kinds, Flag flag) {
-  if (flag == Estimate) return;
-  auto in = vector<InType>(inLayout.size());
-  auto inView = Ranges::View(in, inLayout);
-  auto out = vector<OutType>(outLayout.size());
-  auto outView = Ranges::View(out, outLayout);
-  auto planForward = Ranges::Plan(inView, outView, kinds, flag);
-  auto kindsBackward = kinds;
-  std::ranges::views::all(kindsBackward) |
-      std::ranges::views::transform([](auto kind) { return kind.Inverse(); });
-  auto planBackward = Ranges::Plan(outView, inView, kindsBackward, flag);
+  auto forwardKinds = std::vector<RealKind>(kinds);
+  auto backwardKinds = std::vector<RealKind>();
+  for (auto kind : kinds) backwardKinds.push_back(kind.Inverse());
+  return std::pair(std::make_shared<Ranges::CachedPlan<InType, OutType>>(
+                       inLayout, outLayout, flag, forwardKinds),
+                   std::make_shared<Ranges::CachedPlan<OutType, InType>>(
+                       outLayout, inLayout, flag, backwardKinds));
 }
 
 }  // namespace FFTWpp
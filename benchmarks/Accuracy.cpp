@@ -0,0 +1,208 @@
+#include <FFTWpp/Ranges>
+#include <algorithm>
+#include <complex>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+#include "Benchmark.h"
+
+/*---------------------------------------------------------//
+
+Accuracy against speed for each transform kind, precision,
+planner flag and size class. For each configuration, random
+data are transformed forward and back, and two errors are
+reported as root-mean-square values relative to the data:
+
+  round trip  the inverse of the forward transform against
+              the original data, once normalised.
+
+  reference   the forward transform against the same input
+              transformed in long double. There is no higher
+              precision available for long double itself, and
+              the round trip error is used in its place.
+
+The time is the median time of a forward transform. The
+table is followed by the cheapest configuration of each kind
+and size whose errors are within the budget.
+
+Options:
+  --budget E   error budget (default 1e-6)
+  --quick      omit Patient planning and the large size
+
+//----------------------------------------------------------*/
+
+struct Row {
+  std::string kind;
+  std::string precision;
+  std::string flag;
+  std::string size;
+  double roundTrip = 0;
+  std::optional<double> reference;
+  double seconds = 0;
+
+  // Return the larger of the errors.
+  double Error() const { return std::max(roundTrip, reference.value_or(0)); }
+};
+
+// The long double type of the same form as T.
+template <typename T>
+using Wide = std::conditional_t<NumericConcepts::Complex<T>,
+                                std::complex<long double>, long double>;
+
+// Return the argument giving the inverse transform.
+inline auto Inverse(FFTWpp::Direction direction) {
+  return direction == FFTWpp::Forward ? FFTWpp::Backward : FFTWpp::Forward;
+}
+
+inline auto Inverse(FFTWpp::RealKind kind) { return kind.Inverse(); }
+
+// Measure the errors and time of a transform between the types of size n,
+// with the given arguments for the forward transform.
+template <typename InType, typename OutType, typename... Args>
+Row Run(int n, FFTWpp::Flag flag, Args... args) {
+  using namespace FFTWpp;
+  auto [inLayout, outLayout] =
+      Ranges::Arrange<InType, OutType>(Arrangement::Contiguous, {n}, 1);
+  auto in = Ranges::Allocate<InType>(inLayout);
+  auto out = Ranges::Allocate<OutType>(outLayout);
+  auto back = Ranges::Allocate<InType>(inLayout);
+  auto forward = Ranges::Plan(Ranges::View(in, inLayout),
+                              Ranges::View(out, outLayout), flag, args...);
+  auto backward =
+      Ranges::Plan(Ranges::View(out, outLayout).Consumable(),
+                   Ranges::View(back, inLayout), flag, Inverse(args)...);
+
+  auto row = Row{};
+  RandomiseValues(in);
+  auto copy = in;
+  forward.Execute();
+  if constexpr (!NumericConcepts::LongDouble<
+                    NumericConcepts::RemoveComplex<InType>>) {
+    auto wideIn = Ranges::Allocate<Wide<InType>>(inLayout);
+    auto wideOut = Ranges::Allocate<Wide<OutType>>(outLayout);
+    auto reference = Ranges::Plan(Ranges::View(wideIn, inLayout),
+                                  Ranges::View(wideOut, outLayout), Estimate,
+                                  args...);
+    std::ranges::transform(copy, wideIn.begin(),
+                           [](auto x) { return Wide<InType>(x); });
+    reference.Execute();
+    row.reference = RelativeError(wideOut, out, 1);
+  }
+  backward.Execute();
+  row.roundTrip = RelativeError(copy, back, backward.Normalisation());
+
+  auto once = Time([&]() { forward.Execute(); }, 1, 3);
+  auto calls = std::clamp(static_cast<int>(1e-3 / once), 1, 1000);
+  row.seconds = Time([&]() { forward.Execute(); }, calls);
+  return row;
+}
+
+// Add the rows for a precision.
+template <typename Real>
+void AddRows(std::string precision, std::vector<FFTWpp::Flag> flags,
+             std::map<std::string, int> sizes, std::vector<Row>& rows) {
+  using namespace FFTWpp;
+  using Complex = std::complex<Real>;
+  auto names = std::map<unsigned, std::string>{{Estimate, "Estimate"},
+                                               {Measure, "Measure"},
+                                               {Patient, "Patient"}};
+  for (auto flag : flags) {
+    for (const auto& [size, n] : sizes) {
+      auto add = [&](std::string kind, Row row) {
+        row.kind = kind;
+        row.precision = precision;
+        row.flag = names[flag];
+        row.size = size;
+        rows.push_back(row);
+      };
+      add("c2c", Run<Complex, Complex>(n, flag, Forward));
+      add("r2c", Run<Real, Complex>(n, flag));
+      add("redft10", Run<Real, Real>(n, flag, REDFT10));
+      add("dht", Run<Real, Real>(n, flag, DHT));
+    }
+  }
+}
+
+int main(int argc, char* argv[]) {
+  using namespace FFTWpp;
+  auto budget = 1e-6;
+  auto quick = false;
+  for (auto i = 1; i < argc; i++) {
+    auto option = std::string(argv[i]);
+    if (option == "--budget" && i + 1 < argc) {
+      budget = std::stod(argv[++i]);
+    } else if (option == "--quick") {
+      quick = true;
+    } else {
+      std::cerr << "unknown option " << option << "\n";
+      return 2;
+    }
+  }
+
+  // Sizes with small and large powers of two, a composite with odd factors,
+  // and a prime, for which FFTW uses Rader's algorithm.
+  auto sizes = std::map<std::string, int>{
+      {"small 64", 64}, {"medium 4096", 4096}, {"odd 3000", 3000},
+      {"prime 4099", 4099}};
+  auto flags = std::vector<Flag>{Estimate, Measure};
+  if (!quick) {
+    sizes["large 262144"] = 262144;
+    flags.push_back(Patient);
+  }
+  auto rows = std::vector<Row>();
+  AddRows<float>("float", flags, sizes, rows);
+  AddRows<double>("double", flags, sizes, rows);
+  AddRows<long double>("long double", flags, sizes, rows);
+  CleanUp();
+
+  std::cout << std::setw(10) << "kind" << std::setw(14) << "size"
+            << std::setw(14) << "precision" << std::setw(10) << "flag"
+            << std::setw(14) << "round trip" << std::setw(14) << "reference"
+            << std::setw(12) << "time (us)\n";
+  std::ranges::sort(rows, {}, [](const auto& row) {
+    return std::tie(row.kind, row.size, row.seconds);
+  });
+  for (const auto& row : rows) {
+    std::cout << std::setw(10) << row.kind << std::setw(14) << row.size
+              << std::setw(14) << row.precision << std::setw(10) << row.flag
+              << std::scientific << std::setprecision(2) << std::setw(14)
+              << row.roundTrip << std::setw(14);
+    if (row.reference) {
+      std::cout << *row.reference;
+    } else {
+      std::cout << "-";
+    }
+    std::cout << std::fixed << std::setprecision(3) << std::setw(12)
+              << row.seconds * 1e6 << "\n";
+  }
+
+  // The rows are sorted by time within each kind and size, so the first
+  // within the budget is the cheapest.
+  auto cheapest =
+      std::map<std::pair<std::string, std::string>, std::optional<Row>>();
+  for (const auto& row : rows) {
+    auto& best = cheapest[{row.kind, row.size}];
+    if (!best && row.Error() <= budget) best = row;
+  }
+  std::cout << "\ncheapest within an error budget of " << std::scientific
+            << std::setprecision(1) << budget << "\n";
+  for (const auto& [group, best] : cheapest) {
+    std::cout << std::setw(10) << group.first << std::setw(14) << group.second;
+    if (!best) {
+      std::cout << "  none\n";
+      continue;
+    }
+    std::cout << std::setw(14) << best->precision << std::setw(10)
+              << best->flag << std::scientific << std::setprecision(2)
+              << std::setw(14) << best->Error() << std::fixed
+              << std::setprecision(3) << std::setw(12) << best->seconds * 1e6
+              << "\n";
+  }
+  return 0;
+}
@@ -0,0 +1,50 @@
+#ifndef FFTWPP_BENCHMARK_GUARD_H
+#define FFTWPP_BENCHMARK_GUARD_H
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <vector>
+
+// Returns the times in seconds for a single call of f from the given number
+// of samples, each made up of the given number of calls. An untimed call is
+// made first.
+template <typename F>
+std::vector<double> Samples(F&& f, int calls = 100, int samples = 11) {
+  using Clock = std::chrono::steady_clock;
+  f();
+  auto times = std::vector<double>();
+  for (auto i = 0; i < samples; i++) {
+    auto start = Clock::now();
+    for (auto j = 0; j < calls; j++) f();
+    auto stop = Clock::now();
+    times.push_back(std::chrono::duration<double>(stop - start).count() /
+                    calls);
+  }
+  return times;
+}
+
+// Returns the median of the values.
+inline double Median(std::vector<double> values) {
+  auto middle = values.begin() + values.size() / 2;
+  std::ranges::nth_element(values, middle);
+  return *middle;
+}
+
+// Returns the median absolute deviation of the values from their median.
+inline double MedianAbsoluteDeviation(const std::vector<double>& values) {
+  auto median = Median(values);
+  auto deviations = std::vector<double>();
+  for (auto value : values) deviations.push_back(std::abs(value - median));
+  return Median(deviations);
+}
+
+// Returns the median time in seconds for a single call of f, estimated
+// from the given number of samples each made up of the given number of
+// calls.
+template <typename F>
+double Time(F&& f, int calls = 100, int samples = 11) {
+  return Median(Samples(f, calls, samples));
+}
+
+#endif
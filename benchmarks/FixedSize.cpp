@@ -0,0 +1,85 @@
+#include <FFTWpp/Ranges>
+#include <complex>
+#include <iomanip>
+#include <iostream>
+#include <utility>
+
+#include "Benchmark.h"
+
+/*---------------------------------------------------------//
+
+Compares Ranges::FixedPlan with Ranges::Plan for small
+transforms. Two cases are timed for each size:
+
+(1) a single transform per execute, as when transforms are
+    performed one at a time on separate blocks of data;
+(2) a batch of transforms within one execute.
+
+The time per transform is printed for both plans, along with
+the speedup of the fixed-size kernel. The crossover is the size
+at which the speedup drops below one.
+
+//----------------------------------------------------------*/
+
+template <typename InType, typename OutType, int... Ns>
+void Compare(std::string name, int howMany, auto... args) {
+  using namespace FFTWpp;
+  auto [inSize, outSize] = DataSize<InType, OutType>(Ns...);
+  auto rank = static_cast<int>(sizeof...(Ns));
+  auto realN = std::vector{Ns...};
+  auto complexN = realN;
+  if constexpr (!std::same_as<InType, OutType>) {
+    complexN.back() = complexN.back() / 2 + 1;
+  }
+  auto& inN = NumericConcepts::Real<InType> ? realN : complexN;
+  auto& outN = NumericConcepts::Real<OutType> ? realN : complexN;
+  auto inLayout = Ranges::Layout(rank, inN, howMany, inN, 1, inSize);
+  auto outLayout = Ranges::Layout(rank, outN, howMany, outN, 1, outSize);
+  auto in = vector<InType>(inLayout.size());
+  auto out = vector<OutType>(outLayout.size());
+  auto inView = Ranges::View(in, inLayout);
+  auto outView = Ranges::View(out, outLayout);
+
+  // Measured planning overwrites the arrays, so values are set afterwards.
+  auto fixed = Ranges::MakeFixedPlan<Ns...>(inView, outView, Measure, args...);
+  auto plan = Ranges::Plan(inView, outView, Measure, args...);
+  RandomiseValues(in);
+
+  auto fixedTime = Time([&]() { fixed.Execute(); }) / howMany;
+  auto planTime = Time([&]() { plan.Execute(); }) / howMany;
+
+  std::cout << std::setw(12) << name << std::setw(10) << howMany
+            << std::setw(14) << fixedTime * 1e9 << std::setw(14)
+            << planTime * 1e9 << std::setw(10) << planTime / fixedTime
+            << "\n";
+}
+
+template <int... Ns>
+void CompareSize(std::string name) {
+  using namespace FFTWpp;
+  using Real = double;
+  using Complex = std::complex<Real>;
+  for (auto howMany : {1, 1024}) {
+    Compare<Complex, Complex, Ns...>("C2C " + name, howMany, Forward);
+    Compare<Real, Complex, Ns...>("R2C " + name, howMany);
+    Compare<Real, Real, Ns...>("REDFT10 " + name, howMany, REDFT10);
+  }
+}
+
+int main() {
+  std::cout << std::fixed << std::setprecision(2);
+  std::cout << std::setw(12) << "transform" << std::setw(10) << "howMany"
+            << std::setw(14) << "fixed (ns)" << std::setw(14) << "fftw (ns)"
+            << std::setw(10) << "speedup"
+            << "\n";
+  CompareSize<4>("4");
+  CompareSize<8>("8");
+  CompareSize<12>("12");
+  CompareSize<16>("16");
+  CompareSize<32>("32");
+  CompareSize<64>("64");
+  for (auto howMany : {1, 1024}) {
+    Compare<double, double, 8, 8>("REDFT10 8x8", howMany, FFTWpp::REDFT10);
+  }
+  FFTWpp::CleanUp();
+}
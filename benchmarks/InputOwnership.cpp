@@ -0,0 +1,114 @@
+#include <FFTWpp/Ranges>
+#include <algorithm>
+#include <complex>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "Benchmark.h"
+
+/*---------------------------------------------------------//
+
+Compares transforms of consumable inputs, which are planned
+with DestroyInput, with transforms of preserved inputs. For
+multi-dimensional C2R transforms no algorithms preserve the
+input, so preserved inputs are copied to a scratch array that
+is destroyed instead. The same holds for halfcomplex-to-real
+R2R transforms, whose input-preserving algorithms are slow.
+R2R transforms of other kinds preserve their input without a
+copy and are shown for comparison.
+
+The consumable plans have their own input, which is refreshed
+from the data before each execute, as a caller keeping the
+data would have to. Their timings include this copy, so that
+both columns give the cost of a transform leaving the data
+unchanged.
+
+//----------------------------------------------------------*/
+
+void Print(std::string name, double consumable, double preserved,
+           bool copied) {
+  std::cout << std::setw(24) << name << std::setw(16) << consumable * 1e6
+            << std::setw(16) << preserved * 1e6 << std::setw(10)
+            << preserved / consumable << std::setw(8) << (copied ? "yes" : "no")
+            << "\n";
+}
+
+template <typename... Dimensions>
+void ComplexToReal(Dimensions... dimensions) {
+  using namespace FFTWpp;
+  using Complex = std::complex<double>;
+  auto n = std::vector{dimensions...};
+  auto complexN = n;
+  complexN.back() = n.back() / 2 + 1;
+  auto inLayout = Ranges::Layout(static_cast<int>(n.size()), complexN, 1,
+                                 complexN, 1, 0);
+  auto outLayout =
+      Ranges::Layout(static_cast<int>(n.size()), n, 1, n, 1, 0);
+  auto in = Ranges::Allocate<Complex>(inLayout);
+  auto consumed = Ranges::Allocate<Complex>(inLayout);
+  auto out = Ranges::Allocate<double>(outLayout);
+  auto consumable =
+      Ranges::Plan(Ranges::View(consumed, inLayout).Consumable(),
+                   Ranges::View(out, outLayout), Measure);
+  auto preserved = Ranges::Plan(Ranges::View(in, inLayout).Preserved(),
+                                Ranges::View(out, outLayout), Measure);
+  RandomiseValues(in);
+
+  auto name = std::string("c2r");
+  for (auto dimension : n) name += " " + std::to_string(dimension);
+  auto preservedTime = Time([&]() { preserved.Execute(); }, 10);
+  auto consumableTime = Time(
+      [&]() {
+        std::ranges::copy(in, consumed.begin());
+        consumable.Execute();
+      },
+      10);
+  Print(name, consumableTime, preservedTime, preserved.CopiesInput());
+}
+
+template <typename... Dimensions>
+void RealToReal(FFTWpp::RealKind kind, std::string kindName,
+                Dimensions... dimensions) {
+  using namespace FFTWpp;
+  auto layout = Ranges::Layout(dimensions...);
+  auto in = Ranges::Allocate<double>(layout);
+  auto consumed = Ranges::Allocate<double>(layout);
+  auto out = Ranges::Allocate<double>(layout);
+  auto consumable = Ranges::Plan(Ranges::View(consumed, layout).Consumable(),
+                                 Ranges::View(out, layout), Measure, kind);
+  auto preserved = Ranges::Plan(Ranges::View(in, layout).Preserved(),
+                                Ranges::View(out, layout), Measure, kind);
+  RandomiseValues(in);
+
+  auto name = "r2r " + kindName;
+  for (auto dimension : {dimensions...}) {
+    name += " " + std::to_string(dimension);
+  }
+  auto preservedTime = Time([&]() { preserved.Execute(); }, 10);
+  auto consumableTime = Time(
+      [&]() {
+        std::ranges::copy(in, consumed.begin());
+        consumable.Execute();
+      },
+      10);
+  Print(name, consumableTime, preservedTime, preserved.CopiesInput());
+}
+
+int main() {
+  std::cout << std::fixed << std::setprecision(2);
+  std::cout << std::setw(24) << "transform" << std::setw(16)
+            << "consumable (us)" << std::setw(16) << "preserved (us)"
+            << std::setw(10) << "ratio" << std::setw(8) << "copy"
+            << "\n";
+  ComplexToReal(256, 256);
+  ComplexToReal(1024, 1024);
+  ComplexToReal(64, 64, 64);
+  ComplexToReal(128, 128, 128);
+  RealToReal(FFTWpp::HC2R, "hc2r", 256, 256);
+  RealToReal(FFTWpp::HC2R, "hc2r", 64, 64, 64);
+  RealToReal(FFTWpp::REDFT10, "redft10", 256, 256);
+  RealToReal(FFTWpp::REDFT10, "redft10", 64, 64, 64);
+  FFTWpp::CleanUp();
+}
@@ -0,0 +1,72 @@
+#include <FFTWpp/Ranges>
+#include <complex>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "Benchmark.h"
+
+/*---------------------------------------------------------//
+
+Runs the layout advisor on batches of transforms with a range
+of shapes, printing the fastest arrangement and its speedup
+over the contiguous arrangement. The time taken to reorder a
+contiguous batch into the chosen layout is also printed, which
+shows how many executes are needed for the reorder to pay for
+itself.
+
+//----------------------------------------------------------*/
+
+std::string Name(FFTWpp::Arrangement arrangement) {
+  switch (arrangement) {
+    case FFTWpp::Arrangement::Contiguous:
+      return "contiguous";
+    case FFTWpp::Arrangement::Interleaved:
+      return "interleaved";
+    case FFTWpp::Arrangement::Padded:
+      return "padded";
+  }
+  return "";
+}
+
+template <typename InType, typename OutType>
+void Advise(std::string name, std::vector<int> n, int howMany, auto... args) {
+  using namespace FFTWpp;
+  auto advice = AdviseLayout<InType, OutType>(n, howMany, Measure, args...);
+  auto contiguous = Ranges::Arrange(
+      Arrangement::Contiguous,
+      std::vector<int>(advice.in.N().begin(), advice.in.N().end()), howMany);
+  auto from = vector<InType>(contiguous.size());
+  auto to = vector<InType>(advice.in.size());
+  RandomiseValues(from);
+  auto reorderTime = Time(
+      [&]() {
+        Ranges::Reorder(Ranges::View(from, contiguous),
+                        Ranges::View(to, advice.in));
+      },
+      10);
+  std::cout << std::setw(22) << name << std::setw(10) << howMany
+            << std::setw(14) << Name(advice.arrangement) << std::setw(14)
+            << advice.time * 1e6 << std::setw(10) << advice.Speedup()
+            << std::setw(14) << reorderTime * 1e6 << "\n";
+}
+
+int main() {
+  using namespace FFTWpp;
+  using Complex = std::complex<double>;
+  std::cout << std::fixed << std::setprecision(2);
+  std::cout << std::setw(22) << "transform" << std::setw(10) << "howMany"
+            << std::setw(14) << "layout" << std::setw(14) << "time (us)"
+            << std::setw(10) << "speedup" << std::setw(14) << "reorder (us)"
+            << "\n";
+  for (auto howMany : {16, 256}) {
+    Advise<Complex, Complex>("C2C 64", {64}, howMany, Forward);
+    Advise<Complex, Complex>("C2C 1024", {1024}, howMany, Forward);
+    Advise<double, Complex>("R2C 1024", {1024}, howMany);
+    Advise<Complex, Complex>("C2C 128x128", {128, 128}, howMany, Forward);
+    Advise<double, Complex>("R2C 256x256", {256, 256}, howMany);
+    Advise<double, double>("REDFT10 64x64", {64, 64}, howMany, REDFT10);
+  }
+  CleanUp();
+}
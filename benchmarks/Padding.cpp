@@ -0,0 +1,59 @@
+#include <FFTWpp/Ranges>
+#include <complex>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include "Benchmark.h"
+
+/*---------------------------------------------------------//
+
+Compares transforms of packed arrays with transforms of arrays
+whose embed dimensions are padded by a cache line. With
+power-of-two dimensions, the column passes of a packed array
+repeatedly hit the same cache sets, and padding removes this
+aliasing at the cost of a little extra memory.
+
+All cases are transformed in-place to limit memory use, and the
+largest are planned with Estimate to keep planning time down.
+
+//----------------------------------------------------------*/
+
+template <typename Complex, typename... Dimensions>
+void Compare(std::string name, FFTWpp::Flag flag, int calls,
+             Dimensions... dimensions) {
+  using namespace FFTWpp;
+  auto packed = Ranges::Layout(dimensions...);
+  auto padded =
+      Ranges::Layout(Ranges::Pad::CacheLine<Complex>(), dimensions...);
+
+  auto time = [&](Ranges::Layout layout) {
+    auto data = Ranges::Allocate<Complex>(layout);
+    auto plan = Ranges::Plan(Ranges::View(data, layout),
+                             Ranges::View(data, layout), flag, Forward);
+    RandomiseValues(data);
+    return Time([&]() { plan.Execute(); }, calls, 5);
+  };
+  auto packedTime = time(packed);
+  auto paddedTime = time(padded);
+  auto overhead = 100.0 * (padded.size() - packed.size()) / packed.size();
+  std::cout << std::setw(16) << name << std::setw(14) << packedTime * 1e3
+            << std::setw(14) << paddedTime * 1e3 << std::setw(10)
+            << packedTime / paddedTime << std::setw(12) << overhead << "\n";
+}
+
+int main() {
+  using namespace FFTWpp;
+  std::cout << std::fixed << std::setprecision(2);
+  std::cout << std::setw(16) << "transform" << std::setw(14) << "packed (ms)"
+            << std::setw(14) << "padded (ms)" << std::setw(10) << "speedup"
+            << std::setw(12) << "memory (%)"
+            << "\n";
+  Compare<std::complex<double>>("256x256", Measure, 20, 256, 256);
+  Compare<std::complex<double>>("1024x1024", Measure, 5, 1024, 1024);
+  Compare<std::complex<float>>("1024x1024 (f)", Measure, 5, 1024, 1024);
+  Compare<std::complex<double>>("128^3", Measure, 5, 128, 128, 128);
+  Compare<std::complex<double>>("256^3", Estimate, 2, 256, 256, 256);
+  Compare<std::complex<float>>("512^3 (f)", Estimate, 1, 512, 512, 512);
+  CleanUp();
+}
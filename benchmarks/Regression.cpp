@@ -0,0 +1,264 @@
+#include <FFTWpp/Ranges>
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <regex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "Benchmark.h"
+
+/*---------------------------------------------------------//
+
+Performance regression gate. A representative set of plans is
+timed: batched 1D transforms, 2D and 3D transforms and R2R
+transforms of several kinds, in all precisions. Each workload
+is sampled repeatedly and summarised by the median and the
+median absolute deviation (MAD) of the samples.
+
+With --record FILE the results are written as a JSON baseline,
+and the wisdom of the plans, made with Measure, is exported to
+files with FILE as their base name. With --baseline FILE the
+wisdom is imported and the plans are replayed from it without
+measuring, so that both runs time the same algorithms. Plans
+without wisdom are made with Estimate and marked as such. The
+results are compared against the baseline, and a workload fails
+if its median exceeds the baseline median by more than both a
+relative tolerance and a number of standard deviations of the
+combined noise, estimated from the MADs. Workloads of the
+baseline missing from the run also fail. The exit code is 1 if
+any workload fails, or 77 if the baseline cannot be read, which
+CTest reports as skipped.
+
+Baselines are specific to a machine, and should be recorded
+on the machine that runs the gate.
+
+Options:
+  --baseline FILE   compare against a baseline
+  --record FILE     record a new baseline
+  --samples N       samples per workload (default 21)
+  --tolerance T     relative slowdown allowed (default 0.05)
+  --sigmas K        noise multiples allowed (default 3)
+
+//----------------------------------------------------------*/
+
+struct Result {
+  double median = 0;
+  double mad = 0;
+  int samples = 0;
+  bool estimated = false;  // Planned with Estimate for lack of wisdom.
+};
+
+// Time executes of a plan. The calls per sample are chosen so that each
+// sample takes about a millisecond.
+template <typename PlanType>
+Result Sample(PlanType& plan, int samples) {
+  auto once = Time([&]() { plan.Execute(); }, 1, 3);
+  auto calls = std::clamp(static_cast<int>(1e-3 / once), 1, 1000);
+  auto times = Samples([&]() { plan.Execute(); }, calls, samples);
+  return Result{Median(times), MedianAbsoluteDeviation(times), samples};
+}
+
+// Time a plan with the given flag for a batch of transforms between the
+// types with the given dimensions, falling back to Estimate if a plan for
+// wisdom only cannot be made.
+template <typename InType, typename OutType, typename... Args>
+Result Run(std::vector<int> n, int howMany, int samples, FFTWpp::Flag flag,
+           Args... args) {
+  using namespace FFTWpp;
+  auto [inLayout, outLayout] =
+      Ranges::Arrange<InType, OutType>(Arrangement::Contiguous, n, howMany);
+  auto in = Ranges::Allocate<InType>(inLayout);
+  auto out = Ranges::Allocate<OutType>(outLayout);
+  auto plan = Ranges::Plan(Ranges::View(in, inLayout),
+                           Ranges::View(out, outLayout), flag, args...);
+  RandomiseValues(in);
+  if (!plan.IsNull()) return Sample(plan, samples);
+  auto estimate = Ranges::Plan(Ranges::View(in, inLayout),
+                               Ranges::View(out, outLayout), Estimate,
+                               args...);
+  RandomiseValues(in);
+  auto result = Sample(estimate, samples);
+  result.estimated = true;
+  return result;
+}
+
+using Workload = std::function<Result(int, FFTWpp::Flag)>;
+
+// Add the workloads for a precision, named with the given suffix.
+template <typename Real>
+void AddWorkloads(std::string precision,
+                  std::map<std::string, Workload>& work) {
+  using namespace FFTWpp;
+  using Complex = std::complex<Real>;
+  auto add = [&](std::string name, auto f) {
+    work[name + "-" + precision] = f;
+  };
+  add("c2c-1d-1024x64", [](int samples, Flag flag) {
+    return Run<Complex, Complex>({1024}, 64, samples, flag, Forward);
+  });
+  add("r2c-1d-4096x16", [](int samples, Flag flag) {
+    return Run<Real, Complex>({4096}, 16, samples, flag);
+  });
+  add("c2c-2d-256x256", [](int samples, Flag flag) {
+    return Run<Complex, Complex>({256, 256}, 1, samples, flag, Forward);
+  });
+  add("r2c-3d-64x64x64", [](int samples, Flag flag) {
+    return Run<Real, Complex>({64, 64, 64}, 1, samples, flag);
+  });
+  add("c2r-2d-256x256", [](int samples, Flag flag) {
+    return Run<Complex, Real>({256, 256}, 1, samples, flag);
+  });
+  add("r2r-redft10-2d-128x128", [](int samples, Flag flag) {
+    return Run<Real, Real>({128, 128}, 1, samples, flag, REDFT10);
+  });
+  add("r2r-dht-1d-2048x16", [](int samples, Flag flag) {
+    return Run<Real, Real>({2048}, 16, samples, flag, DHT);
+  });
+}
+
+std::map<std::string, Workload> Workloads() {
+  auto work = std::map<std::string, Workload>();
+  AddWorkloads<float>("float", work);
+  AddWorkloads<double>("double", work);
+  AddWorkloads<long double>("longdouble", work);
+  return work;
+}
+
+bool WriteBaseline(const std::string& filename,
+                   const std::map<std::string, Result>& results) {
+  auto file = std::ofstream(filename);
+  file << std::setprecision(9) << "{\n";
+#if defined(__VERSION__)
+  file << "  \"compiler\": \"" << __VERSION__ << "\",\n";
+#endif
+  file << "  \"workloads\": {";
+  auto first = true;
+  for (const auto& [name, result] : results) {
+    file << (first ? "\n" : ",\n") << "    \"" << name
+         << "\": {\"median\": " << result.median
+         << ", \"mad\": " << result.mad
+         << ", \"samples\": " << result.samples << "}";
+    first = false;
+  }
+  file << "\n  }\n}\n";
+  return static_cast<bool>(file);
+}
+
+// Read a baseline written by WriteBaseline.
+std::map<std::string, Result> ReadBaseline(const std::string& filename) {
+  auto file = std::ifstream(filename);
+  auto stream = std::ostringstream();
+  stream << file.rdbuf();
+  auto text = stream.str();
+  auto pattern = std::regex(
+      R"re("([^"]+)"\s*:\s*\{\s*"median"\s*:\s*([^,\s]+)\s*,\s*"mad"\s*:\s*)re"
+      R"re(([^,\s]+)\s*,\s*"samples"\s*:\s*(\d+)\s*\})re");
+  auto baseline = std::map<std::string, Result>();
+  for (auto it = std::sregex_iterator(text.begin(), text.end(), pattern);
+       it != std::sregex_iterator(); it++) {
+    auto& match = *it;
+    baseline[match[1]] = Result{std::stod(match[2]), std::stod(match[3]),
+                                std::stoi(match[4])};
+  }
+  return baseline;
+}
+
+int main(int argc, char* argv[]) {
+  auto baselineFile = std::string();
+  auto recordFile = std::string();
+  auto samples = 21;
+  auto tolerance = 0.05;
+  auto sigmas = 3.0;
+  for (auto i = 1; i + 1 < argc; i += 2) {
+    auto option = std::string(argv[i]);
+    auto value = std::string(argv[i + 1]);
+    if (option == "--baseline") {
+      baselineFile = value;
+    } else if (option == "--record") {
+      recordFile = value;
+    } else if (option == "--samples") {
+      samples = std::stoi(value);
+    } else if (option == "--tolerance") {
+      tolerance = std::stod(value);
+    } else if (option == "--sigmas") {
+      sigmas = std::stod(value);
+    } else {
+      std::cerr << "unknown option " << option << "\n";
+      return 2;
+    }
+  }
+
+  auto baseline = std::map<std::string, Result>();
+  auto flag = FFTWpp::Measure;
+  if (!baselineFile.empty()) {
+    baseline = ReadBaseline(baselineFile);
+    if (baseline.empty()) {
+      std::cout << "no baseline in " << baselineFile
+                << "; record one with --record\n";
+      return 77;
+    }
+    FFTWpp::ImportWisdomFiles(baselineFile);
+    flag = FFTWpp::Measure | FFTWpp::WisdomOnly;
+  }
+
+  std::cout << std::setw(32) << "workload" << std::setw(14) << "median (us)"
+            << std::setw(12) << "MAD (us)" << std::setw(14) << "base (us)"
+            << std::setw(10) << "ratio" << "  verdict\n";
+  auto results = std::map<std::string, Result>();
+  auto failures = 0;
+  for (const auto& [name, run] : Workloads()) {
+    auto result = run(samples, flag);
+    results[name] = result;
+    std::cout << std::fixed << std::setprecision(3) << std::setw(32) << name
+              << std::setw(14) << result.median * 1e6 << std::setw(12)
+              << result.mad * 1e6;
+    auto it = baseline.find(name);
+    if (it == baseline.end()) {
+      std::cout << std::setw(14) << "-" << std::setw(10) << "-"
+                << (baseline.empty() ? "\n" : "  new\n");
+      continue;
+    }
+    // The MAD scaled by 1.4826 estimates the standard deviation of normal
+    // noise.
+    auto base = it->second;
+    auto noise = 1.4826 * std::hypot(base.mad, result.mad);
+    auto threshold = std::max(tolerance * base.median, sigmas * noise);
+    auto change = result.median - base.median;
+    auto verdict = change > threshold    ? "SLOWER"
+                   : -change > threshold ? "faster"
+                                         : "ok";
+    if (change > threshold) failures++;
+    std::cout << std::setw(14) << base.median * 1e6 << std::setw(10)
+              << result.median / base.median << "  " << verdict
+              << (result.estimated ? " (estimate)\n" : "\n");
+  }
+  for (const auto& [name, base] : baseline) {
+    if (results.contains(name)) continue;
+    failures++;
+    std::cout << std::setw(32) << name << std::setw(14) << "-"
+              << std::setw(12) << "-" << std::setw(14) << base.median * 1e6
+              << std::setw(10) << "-" << "  MISSING\n";
+  }
+
+  if (!recordFile.empty()) {
+    if (!WriteBaseline(recordFile, results) ||
+        !FFTWpp::ExportWisdomFiles(recordFile)) {
+      std::cerr << "cannot write " << recordFile << "\n";
+      return 2;
+    }
+    std::cout << "recorded baseline in " << recordFile << "\n";
+  }
+  FFTWpp::CleanUp();
+  if (failures > 0) {
+    std::cout << failures << " workloads are significantly slower or missing\n";
+    return 1;
+  }
+  return 0;
+}
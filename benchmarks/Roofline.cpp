@@ -0,0 +1,260 @@
+#include <FFTWpp/Ranges>
+#include <algorithm>
+#include <array>
+#include <complex>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "Benchmark.h"
+
+/*---------------------------------------------------------//
+
+Roofline report for a set of transform workloads. The host is
+first characterised with two micro-kernels on a single thread:
+
+  bandwidth  the STREAM triad a = b + s c over arrays much
+             larger than the last-level cache, counting the
+             bytes of the three arrays.
+
+  peak       independent multiply-add chains in each
+             precision, which the compiler vectorises. There
+             are enough chains to fill the widest vectors for
+             the latency of a multiply-add on two ports, so
+             that the rate is bound by throughput. Build with
+             -O3 -march=native to reach the widest vector
+             units, as the fftw3 codelets do. The compiler,
+             flags and vector extensions of the build are
+             reported with the peaks.
+
+For each workload the operations counted by fftw_flops and the
+bytes of the input and output layouts give the arithmetic
+intensity. The roof is the lesser of the peak and the intensity
+times the bandwidth, and the achieved rate is reported as a
+percentage of it. Workloads whose data fit in cache can exceed
+the memory roof.
+
+Options:
+  --json FILE      also write the report as JSON
+  --stream-mb N    megabytes of each triad array (default 128)
+
+//----------------------------------------------------------*/
+
+struct Machine {
+  std::string build;                    // Compiler, flags and extensions.
+  double bandwidth = 0;                 // Bytes per second.
+  std::map<std::string, double> peaks;  // Flops per second by precision.
+};
+
+struct Result {
+  std::string name;
+  std::string precision;
+  double flops = 0;
+  double bytes = 0;
+  double seconds = 0;
+
+  double Intensity() const { return flops / bytes; }
+  double Rate() const { return flops / seconds; }
+};
+
+// Return the best bandwidth of the STREAM triad over arrays of the given
+// number of doubles.
+double TriadBandwidth(std::size_t n) {
+  auto a = std::vector<double>(n, 0);
+  auto b = std::vector<double>(n, 1);
+  auto c = std::vector<double>(n, 2);
+  auto s = 3.0;
+  auto times = Samples(
+      [&]() {
+        for (auto i = std::size_t{0}; i < n; i++) a[i] = b[i] + s * c[i];
+      },
+      1, 10);
+  return 3 * sizeof(double) * n / std::ranges::min(times);
+}
+
+// Return the compiler, flags and vector extensions of the build.
+std::string BuildFlags() {
+  auto build = std::string("unknown compiler");
+#if defined(__clang__)
+  build = "clang " __clang_version__;
+#elif defined(__GNUC__)
+  build = "gcc " __VERSION__;
+#endif
+#ifdef FFTWPP_BUILD_FLAGS
+  build += " " FFTWPP_BUILD_FLAGS;
+#endif
+#ifdef __AVX512F__
+  build += " avx512f";
+#endif
+#ifdef __AVX2__
+  build += " avx2";
+#endif
+#ifdef __FMA__
+  build += " fma";
+#endif
+#ifdef __ARM_NEON
+  build += " neon";
+#endif
+  return build;
+}
+
+// Return the best rate of floating-point operations of independent
+// multiply-add chains in the given precision. The chains fill 64-byte
+// vectors ten times over, covering a latency of up to five cycles on two
+// ports.
+template <typename Real>
+double PeakFlops() {
+  constexpr auto lanes = static_cast<int>(10 * 64 / sizeof(Real));
+  constexpr auto iterations = 1 << 16;
+  auto x = std::array<Real, lanes>{};
+  for (auto i = 0; i < lanes; i++) x[i] = 1 + static_cast<Real>(i) / 1000;
+  const auto a = static_cast<Real>(0.999999);
+  const auto b = static_cast<Real>(1e-6);
+  auto times = Samples(
+      [&]() {
+        for (auto i = 0; i < iterations; i++) {
+          for (auto& value : x) value = value * a + b;
+        }
+      },
+      1, 10);
+  // Use the values so that the chains are not optimised away.
+  volatile auto sink = x[0];
+  static_cast<void>(sink);
+  return 2.0 * lanes * iterations / std::ranges::min(times);
+}
+
+// Time a transform between the types with the given dimensions.
+template <typename InType, typename OutType, typename... Args>
+Result Run(std::string name, std::vector<int> n, int howMany, Args... args) {
+  using namespace FFTWpp;
+  auto [inLayout, outLayout] =
+      Ranges::Arrange<InType, OutType>(Arrangement::Contiguous, n, howMany);
+  auto in = Ranges::Allocate<InType>(inLayout);
+  auto out = Ranges::Allocate<OutType>(outLayout);
+  auto plan = Ranges::Plan(Ranges::View(in, inLayout),
+                           Ranges::View(out, outLayout), Measure, args...);
+  RandomiseValues(in);
+  auto once = Time([&]() { plan.Execute(); }, 1, 3);
+  auto calls = std::clamp(static_cast<int>(1e-2 / once), 1, 1000);
+  auto result = Result{};
+  result.name = name;
+  result.flops = plan.Flops();
+  result.bytes = TouchedBytes(plan);
+  result.seconds = Time([&]() { plan.Execute(); }, calls);
+  return result;
+}
+
+// Add the workloads for a precision.
+template <typename Real>
+void AddResults(std::string precision, std::vector<Result>& results) {
+  using namespace FFTWpp;
+  using Complex = std::complex<Real>;
+  auto add = [&](Result result) {
+    result.precision = precision;
+    results.push_back(result);
+  };
+  add(Run<Complex, Complex>("c2c 1d 1024 x 4096", {1024}, 4096, Forward));
+  add(Run<Complex, Complex>("c2c 1d 1048576", {1048576}, 1, Forward));
+  add(Run<Real, Complex>("r2c 2d 1024^2", {1024, 1024}, 1));
+  add(Run<Complex, Complex>("c2c 3d 128^3", {128, 128, 128}, 1, Forward));
+  add(Run<Real, Real>("redft10 2d 512^2", {512, 512}, 1, REDFT10));
+}
+
+// Return the roof in flops per second of a workload.
+double Roof(const Machine& machine, const Result& result) {
+  return std::min(machine.peaks.at(result.precision),
+                  result.Intensity() * machine.bandwidth);
+}
+
+bool WriteJson(const std::string& filename, const Machine& machine,
+               const std::vector<Result>& results) {
+  auto file = std::ofstream(filename);
+  file << std::setprecision(6) << "{\n  \"build\": \"" << machine.build
+       << "\",\n  \"bandwidth_gbs\": " << machine.bandwidth * 1e-9
+       << ",\n  \"peak_gflops\": {";
+  auto first = true;
+  for (const auto& [precision, peak] : machine.peaks) {
+    file << (first ? "" : ", ") << "\"" << precision << "\": " << peak * 1e-9;
+    first = false;
+  }
+  file << "},\n  \"workloads\": [";
+  first = true;
+  for (const auto& result : results) {
+    auto roof = Roof(machine, result);
+    file << (first ? "\n" : ",\n") << "    {\"name\": \"" << result.name
+         << "\", \"precision\": \"" << result.precision
+         << "\", \"flops\": " << result.flops
+         << ", \"bytes\": " << result.bytes
+         << ", \"intensity\": " << result.Intensity()
+         << ", \"seconds\": " << result.seconds
+         << ", \"gflops\": " << result.Rate() * 1e-9
+         << ", \"roof_gflops\": " << roof * 1e-9
+         << ", \"percent\": " << 100 * result.Rate() / roof
+         << ", \"bound\": \""
+         << (roof < machine.peaks.at(result.precision) ? "memory" : "compute")
+         << "\"}";
+    first = false;
+  }
+  file << "\n  ]\n}\n";
+  return static_cast<bool>(file);
+}
+
+int main(int argc, char* argv[]) {
+  auto jsonFile = std::string();
+  auto streamMegabytes = 128;
+  for (auto i = 1; i + 1 < argc; i += 2) {
+    auto option = std::string(argv[i]);
+    auto value = std::string(argv[i + 1]);
+    if (option == "--json") {
+      jsonFile = value;
+    } else if (option == "--stream-mb") {
+      streamMegabytes = std::stoi(value);
+    } else {
+      std::cerr << "unknown option " << option << "\n";
+      return 2;
+    }
+  }
+
+  auto machine = Machine{};
+  machine.build = BuildFlags();
+  machine.bandwidth = TriadBandwidth(
+      static_cast<std::size_t>(streamMegabytes) * (1 << 20) / sizeof(double));
+  machine.peaks["float"] = PeakFlops<float>();
+  machine.peaks["double"] = PeakFlops<double>();
+  std::cout << std::fixed << std::setprecision(2) << "build "
+            << machine.build << "\ntriad bandwidth "
+            << machine.bandwidth * 1e-9 << " GB/s\n";
+  for (const auto& [precision, peak] : machine.peaks) {
+    std::cout << "peak " << precision << " " << peak * 1e-9 << " GFLOP/s\n";
+  }
+
+  auto results = std::vector<Result>();
+  AddResults<float>("float", results);
+  AddResults<double>("double", results);
+  FFTWpp::CleanUp();
+
+  std::cout << "\n"
+            << std::setw(22) << "workload" << std::setw(12) << "precision"
+            << std::setw(12) << "flop/byte" << std::setw(12) << "GFLOP/s"
+            << std::setw(12) << "roof" << std::setw(10) << "% roof"
+            << "  bound\n";
+  for (const auto& result : results) {
+    auto roof = Roof(machine, result);
+    auto bound =
+        roof < machine.peaks.at(result.precision) ? "memory" : "compute";
+    std::cout << std::setw(22) << result.name << std::setw(12)
+              << result.precision << std::setw(12) << result.Intensity()
+              << std::setw(12) << result.Rate() * 1e-9 << std::setw(12)
+              << roof * 1e-9 << std::setw(10) << 100 * result.Rate() / roof
+              << "  " << bound << "\n";
+  }
+
+  if (!jsonFile.empty() && !WriteJson(jsonFile, machine, results)) {
+    std::cerr << "cannot write " << jsonFile << "\n";
+    return 2;
+  }
+  return 0;
+}
@@ -0,0 +1,132 @@
+#include <FFTWpp/Ranges>
+#include <complex>
+#include <iomanip>
+#include <iostream>
+#include <span>
+#include <string>
+
+#include "Benchmark.h"
+
+/*---------------------------------------------------------//
+
+Compares transforms using the named layouts, which work on the
+data where it lies, with copying the data into a packed array
+and transforming that. Three cases are timed:
+
+(1) channel-interleaved real data, as for multichannel audio;
+(2) a column-major array, as stored by Fortran;
+(3) a block within a larger row-major array.
+
+The copy for the second case is a transpose, and the results of
+the packed transform are left in the packed layout, which
+favours the copying approach.
+
+//----------------------------------------------------------*/
+
+void Print(std::string name, double direct, double copied) {
+  std::cout << std::setw(24) << name << std::setw(14) << direct * 1e6
+            << std::setw(14) << copied * 1e6 << std::setw(10)
+            << copied / direct << "\n";
+}
+
+void Interleaved(int channels, int n) {
+  using namespace FFTWpp;
+  using Complex = std::complex<double>;
+  auto inLayout = Ranges::InterleavedLayout(channels, n);
+  auto outLayout = Ranges::InterleavedLayout(channels, n / 2 + 1);
+  auto in = Ranges::Allocate<double>(inLayout);
+  auto out = Ranges::Allocate<Complex>(outLayout);
+  auto plan = Ranges::Plan(Ranges::View(in, inLayout),
+                           Ranges::View(out, outLayout), Measure);
+
+  auto packedIn = Ranges::Arrange(Arrangement::Contiguous, {n}, channels);
+  auto packedOut =
+      Ranges::Arrange(Arrangement::Contiguous, {n / 2 + 1}, channels);
+  auto copy = Ranges::Allocate<double>(packedIn);
+  auto copyOut = Ranges::Allocate<Complex>(packedOut);
+  auto packed = Ranges::Plan(Ranges::View(copy, packedIn),
+                             Ranges::View(copyOut, packedOut), Measure);
+  RandomiseValues(in);
+
+  auto direct = Time([&]() { plan.Execute(); });
+  auto copied = Time([&]() {
+    Ranges::Reorder(inLayout, in.data(), packedIn, copy.data());
+    packed.Execute();
+  });
+  Print("interleaved " + std::to_string(channels) + "x" + std::to_string(n),
+        direct, copied);
+}
+
+void ColumnMajor(int n0, int n1) {
+  using namespace FFTWpp;
+  using Complex = std::complex<double>;
+  auto layout = Ranges::ColumnMajorLayout(n0, n1);
+  auto in = Ranges::Allocate<Complex>(layout);
+  auto out = Ranges::Allocate<Complex>(layout);
+  auto plan = Ranges::Plan(Ranges::View(in, layout), Ranges::View(out, layout),
+                           Measure, Forward);
+
+  auto copy = vector<Complex>(n0 * n1);
+  auto copyOut = vector<Complex>(n0 * n1);
+  auto packed = Ranges::Plan(Ranges::View(copy, n0, n1),
+                             Ranges::View(copyOut, n0, n1), Measure, Forward);
+  RandomiseValues(in);
+
+  auto direct = Time([&]() { plan.Execute(); }, 10);
+  auto copied = Time(
+      [&]() {
+        for (auto i = 0; i < n0; i++) {
+          for (auto j = 0; j < n1; j++) copy[i * n1 + j] = in[i + j * n0];
+        }
+        packed.Execute();
+      },
+      10);
+  Print("column-major " + std::to_string(n0) + "x" + std::to_string(n1),
+        direct, copied);
+}
+
+void SubBlock(int n, int parent) {
+  using namespace FFTWpp;
+  using Complex = std::complex<double>;
+  auto layout = Ranges::SubBlockLayout({n, n}, {parent, parent});
+  auto offset = Ranges::SubBlockOffset({parent / 4, parent / 4},
+                                       {parent, parent});
+  auto data = vector<Complex>(parent * parent);
+  auto out = vector<Complex>(n * n);
+  auto view = std::span(data).subspan(offset);
+  auto plan = Ranges::Plan(Ranges::View(view, layout),
+                           Ranges::View(out, n, n), Measure, Forward);
+
+  auto copy = vector<Complex>(n * n);
+  auto packed = Ranges::Plan(Ranges::View(copy, n, n), Ranges::View(out, n, n),
+                             Measure, Forward);
+  RandomiseValues(data);
+
+  auto direct = Time([&]() { plan.Execute(); }, 10);
+  auto copied = Time(
+      [&]() {
+        for (auto i = 0; i < n; i++) {
+          std::ranges::copy_n(view.begin() + i * parent, n,
+                              copy.begin() + i * n);
+        }
+        packed.Execute();
+      },
+      10);
+  Print("block " + std::to_string(n) + " of " + std::to_string(parent), direct,
+        copied);
+}
+
+int main() {
+  std::cout << std::fixed << std::setprecision(2);
+  std::cout << std::setw(24) << "layout" << std::setw(14) << "direct (us)"
+            << std::setw(14) << "copied (us)" << std::setw(10) << "speedup"
+            << "\n";
+  Interleaved(2, 4096);
+  Interleaved(8, 4096);
+  Interleaved(32, 1024);
+  ColumnMajor(256, 256);
+  ColumnMajor(512, 384);
+  SubBlock(256, 1024);
+  SubBlock(512, 1024);
+  FFTWpp::CleanUp();
+}
@@ -7,6 +7,8 @@
 #   FFTW_FOUND               ... true if fftw is found on the system
 #   FFTW_LIBRARIES           ... full path to fftw library
 #   FFTW_INCLUDES            ... fftw include directory
+#   FFTW_THREADS_FOUND       ... true if the threaded fftw libraries are found
+#   FFTW_THREADS_LIBRARIES   ... full paths to the threaded fftw libraries
 #
 # The following variables will be checked by the function
 #   FFTW_USE_STATIC_LIBS    ... if true, only static libraries are found
@@ -87,6 +89,23 @@ else()
     PATHS ${PKG_FFTW_INCLUDE_DIRS} ${INCLUDE_INSTALL_DIR}
   )
 endif()
+#find the threaded libraries
+foreach(prefix FFTW FFTWF FFTWL)
+  string(TOLOWER ${prefix} name)
+  string(REPLACE "fftw" "fftw3" name ${name})
+  find_library(
+    ${prefix}_THREADS_LIB
+    NAMES "${name}_threads"
+    PATHS ${FFTW_ROOT} ${PKG_FFTW_LIBRARY_DIRS} ${LIB_INSTALL_DIR}
+    PATH_SUFFIXES "lib" "lib64"
+  )
+endforeach()
+if(FFTW_THREADS_LIB AND FFTWF_THREADS_LIB AND FFTWL_THREADS_LIB)
+  set(FFTW_THREADS_FOUND TRUE)
+  set(FFTW_THREADS_LIBRARIES ${FFTW_THREADS_LIB} ${FFTWF_THREADS_LIB} ${FFTWL_THREADS_LIB})
+else()
+  set(FFTW_THREADS_FOUND FALSE)
+endif()
 set(FFTW_LIBRARIES ${FFTW_LIB} ${FFTWF_LIB})
 if(FFTWL_LIB)
   set(FFTW_LIBRARIES ${FFTW_LIBRARIES} ${FFTWL_LIB})
@@ -95,4 +114,5 @@ set( CMAKE_FIND_LIBRARY_SUFFIXES ${CMAKE_FIND_LIBRARY_SUFFIXES_SAV} )
 include(FindPackageHandleStandardArgs)
 find_package_handle_standard_args(FFTW DEFAULT_MSG
                                   FFTW_INCLUDES FFTW_LIBRARIES)
-mark_as_advanced(FFTW_INCLUDES FFTW_LIBRARIES FFTW_LIB FFTWF_LIB FFTWL_LIB)
+mark_as_advanced(FFTW_INCLUDES FFTW_LIBRARIES FFTW_LIB FFTWF_LIB FFTWL_LIB
+                 FFTW_THREADS_LIB FFTWF_THREADS_LIB FFTWL_THREADS_LIB)
@@ -0,0 +1,77 @@
+#include <FFTWpp/Ranges>
+#include <complex>
+#include <csignal>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// This example shows how processes on a host can share a transform service
+// that holds the plans, wisdom and threads. Run one process as the service
+// with "Example5 serve PATH", and others as clients with "Example5 PATH".
+// A client allocates a shared buffer, writes its data there, and submits
+// transforms of it, which the service performs without copying the data.
+
+namespace {
+FFTWpp::TransformService* service = nullptr;
+}
+
+int main(int argc, char* argv[]) {
+  using namespace FFTWpp;
+  using Real = double;
+  using Complex = std::complex<Real>;
+
+  if (argc == 3 && std::string(argv[1]) == "serve") {
+    // Serve until interrupted, keeping wisdom in files with this base name.
+    auto server = TransformService(argv[2], 4, "ServiceWisdom");
+    if (!server.Listening()) {
+      std::cerr << "cannot listen at " << argv[2] << "\n";
+      return 1;
+    }
+    service = &server;
+    std::signal(SIGINT, [](int) { service->Stop(); });
+    server.Run();
+    std::cout << server.Jobs() << " jobs in " << server.Batches()
+              << " batches\n";
+    return 0;
+  }
+  if (argc != 2) {
+    std::cerr << "usage: Example5 serve PATH | Example5 PATH\n";
+    return 2;
+  }
+
+  auto client = TransformClient(argv[1]);
+  if (!client.Connected()) {
+    std::cerr << "no service at " << argv[1] << "\n";
+    return 1;
+  }
+
+  // Allocate a buffer holding the input and output of a batch of
+  // transforms, one after the other.
+  auto n = 256;
+  auto howMany = 8;
+  auto sizes = std::vector{n};
+  auto layout = Ranges::Layout(1, sizes, howMany, sizes, 1, n);
+  auto bytes = layout.size() * sizeof(Complex);
+  auto buffer = client.Allocate(2 * bytes);
+
+  // Spans within the buffer can be used like any other data.
+  auto in = buffer.Span<Complex>(0, layout.size());
+  auto out = buffer.Span<Complex>(bytes, layout.size());
+  RandomiseValues(in);
+  auto copy = std::vector(in.begin(), in.end());
+
+  // Transform forward into the output, and back into the input.
+  auto forward = client.Transform<Complex, Complex>(buffer, 0, layout, bytes,
+                                                    layout, Measure, Forward);
+  auto backward = client.Transform<Complex, Complex>(
+      buffer, bytes, layout, 0, layout, Measure, Backward);
+  if (!forward || !backward) {
+    std::cerr << "transform failed\n";
+    return 1;
+  }
+  auto norm = static_cast<Real>(1) / n;
+  auto passed = CheckValues(std::span(copy), std::span(in.data(), in.size()),
+                            Complex(norm));
+  std::cout << "round trip " << (passed ? "passed" : "failed") << "\n";
+  client.Release(buffer);
+}
@@ -0,0 +1,217 @@
+// Interposes the allocation, locking and system call functions used by the
+// real-time safety tests. The executable's definitions take precedence over
+// those in the shared libraries, and forward to glibc's implementations.
+
+#include "RealTimeHooks.h"
+
+#include <atomic>
+
+#if defined(__linux__) && defined(__GLIBC__)
+#define FFTWPP_REALTIME_HOOKS
+#endif
+
+namespace {
+
+std::atomic<int> armed{0};
+std::atomic<long> allocations{0};
+std::atomic<long> locks{0};
+std::atomic<long> syscalls{0};
+
+void Count(std::atomic<long>& counter) {
+  if (armed.load(std::memory_order_relaxed) > 0) {
+    counter.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+RealTimeViolations Current() {
+  return {allocations.load(), locks.load(), syscalls.load()};
+}
+
+}  // namespace
+
+RealTimeRegion::RealTimeRegion() {
+  _start = Current();
+  armed++;
+}
+
+RealTimeRegion::~RealTimeRegion() { armed--; }
+
+RealTimeViolations RealTimeRegion::Violations() const {
+  auto now = Current();
+  return {now.allocations - _start.allocations, now.locks - _start.locks,
+          now.syscalls - _start.syscalls};
+}
+
+bool RealTimeRegion::Supported() {
+#ifdef FFTWPP_REALTIME_HOOKS
+  return true;
+#else
+  return false;
+#endif
+}
+
+#ifdef FFTWPP_REALTIME_HOOKS
+
+#include <dlfcn.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include <time.h>
+
+#include <cerrno>
+#include <cstdarg>
+#include <cstddef>
+#include <new>
+
+extern "C" {
+void* __libc_malloc(std::size_t);
+void* __libc_calloc(std::size_t, std::size_t);
+void* __libc_realloc(void*, std::size_t);
+void* __libc_memalign(std::size_t, std::size_t);
+void __libc_free(void*);
+}
+
+namespace {
+
+// Return the next definition of the named function.
+template <typename F>
+F Next(F& cached, const char* name) {
+  if (!cached) cached = reinterpret_cast<F>(dlsym(RTLD_NEXT, name));
+  return cached;
+}
+
+}  // namespace
+
+extern "C" {
+
+void* malloc(std::size_t size) {
+  Count(allocations);
+  return __libc_malloc(size);
+}
+
+void* calloc(std::size_t count, std::size_t size) {
+  Count(allocations);
+  return __libc_calloc(count, size);
+}
+
+void* realloc(void* p, std::size_t size) {
+  Count(allocations);
+  return __libc_realloc(p, size);
+}
+
+void* aligned_alloc(std::size_t alignment, std::size_t size) {
+  Count(allocations);
+  return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void** p, std::size_t alignment, std::size_t size) {
+  Count(allocations);
+  *p = __libc_memalign(alignment, size);
+  return *p ? 0 : ENOMEM;
+}
+
+void free(void* p) {
+  if (p) Count(allocations);
+  __libc_free(p);
+}
+
+int pthread_mutex_lock(pthread_mutex_t* mutex) {
+  static int (*next)(pthread_mutex_t*) = nullptr;
+  Count(locks);
+  return Next(next, "pthread_mutex_lock")(mutex);
+}
+
+ssize_t read(int fd, void* buffer, std::size_t count) {
+  static ssize_t (*next)(int, void*, std::size_t) = nullptr;
+  Count(syscalls);
+  return Next(next, "read")(fd, buffer, count);
+}
+
+ssize_t write(int fd, const void* buffer, std::size_t count) {
+  static ssize_t (*next)(int, const void*, std::size_t) = nullptr;
+  Count(syscalls);
+  return Next(next, "write")(fd, buffer, count);
+}
+
+void* mmap(void* address, std::size_t length, int protection, int flags,
+           int fd, off_t offset) {
+  static void* (*next)(void*, std::size_t, int, int, int, off_t) = nullptr;
+  Count(syscalls);
+  return Next(next, "mmap")(address, length, protection, flags, fd, offset);
+}
+
+int munmap(void* address, std::size_t length) {
+  static int (*next)(void*, std::size_t) = nullptr;
+  Count(syscalls);
+  return Next(next, "munmap")(address, length);
+}
+
+int nanosleep(const struct timespec* request, struct timespec* remaining) {
+  static int (*next)(const struct timespec*, struct timespec*) = nullptr;
+  Count(syscalls);
+  return Next(next, "nanosleep")(request, remaining);
+}
+
+int sched_yield() {
+  static int (*next)() = nullptr;
+  Count(syscalls);
+  return Next(next, "sched_yield")();
+}
+
+long syscall(long number, ...) {
+  static long (*next)(long, ...) = nullptr;
+  Count(syscalls);
+  va_list args;
+  va_start(args, number);
+  long a[6];
+  for (auto& arg : a) arg = va_arg(args, long);
+  va_end(args);
+  return Next(next, "syscall")(number, a[0], a[1], a[2], a[3], a[4], a[5]);
+}
+
+}  // extern "C"
+
+void* operator new(std::size_t size) {
+  Count(allocations);
+  if (auto p = __libc_malloc(size ? size : 1)) return p;
+  throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) { return operator new(size); }
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+  Count(allocations);
+  auto align = static_cast<std::size_t>(alignment);
+  if (auto p = __libc_memalign(align, size ? size : 1)) return p;
+  throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+  return operator new(size, alignment);
+}
+
+void operator delete(void* p) noexcept {
+  if (p) Count(allocations);
+  __libc_free(p);
+}
+
+void operator delete[](void* p) noexcept { operator delete(p); }
+
+void operator delete(void* p, std::size_t) noexcept { operator delete(p); }
+
+void operator delete[](void* p, std::size_t) noexcept { operator delete(p); }
+
+void operator delete(void* p, std::align_val_t) noexcept { operator delete(p); }
+
+void operator delete[](void* p, std::align_val_t) noexcept {
+  operator delete(p);
+}
+
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept {
+  operator delete(p);
+}
+
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept {
+  operator delete(p);
+}
+
+#endif
@@ -0,0 +1,35 @@
+#ifndef FFTWPP_REALTIMEHOOKS_GUARD_H
+#define FFTWPP_REALTIMEHOOKS_GUARD_H
+
+// Counts of operations that violate real-time constraints.
+struct RealTimeViolations {
+  long allocations = 0;  // Calls to malloc, free, operator new and the like.
+  long locks = 0;        // Calls to pthread_mutex_lock.
+  long syscalls = 0;     // Calls to common system call wrappers.
+
+  bool None() const { return allocations == 0 && locks == 0 && syscalls == 0; }
+};
+
+// Marks a region of code within which the operations above are counted.
+// Counting is process-wide while any region is active, so that work done
+// on other threads on behalf of the region is included. Interception is
+// only supported on Linux with glibc, and elsewhere nothing is counted.
+class RealTimeRegion {
+ public:
+  RealTimeRegion();
+  ~RealTimeRegion();
+
+  RealTimeRegion(const RealTimeRegion&) = delete;
+  RealTimeRegion& operator=(const RealTimeRegion&) = delete;
+
+  // Return the operations counted since the region began.
+  RealTimeViolations Violations() const;
+
+  // Returns true if the operations can be intercepted.
+  static bool Supported();
+
+ private:
+  RealTimeViolations _start;
+};
+
+#endif
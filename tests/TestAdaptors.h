@@ -0,0 +1,66 @@
+#ifndef FFTWPP_TESTADAPTORS_GUARD_H
+#define FFTWPP_TESTADAPTORS_GUARD_H
+
+#include <FFTWpp/Ranges>
+#include <complex>
+#include <random>
+#include <ranges>
+#include <vector>
+
+// Computes windowed power spectra with the range adaptors and checks them
+// against those found frame by frame.
+template <NumericConcepts::Real Real>
+auto TestPowerSpectra(int chunk) {
+  using namespace FFTWpp;
+  using Complex = std::complex<Real>;
+  std::random_device rd;
+  std::mt19937 gen(rd());
+  std::uniform_int_distribution<> d(10, 100);
+  int n = d(gen);
+  int count = d(gen);
+  auto frames = std::vector<vector<Real>>(count, vector<Real>(n));
+  for (auto& frame : frames) RandomiseValues(frame);
+  auto hann = Hann<Real>(n);
+
+  auto in = vector<Real>(n);
+  auto out = vector<Complex>(n / 2 + 1);
+  auto plan = Ranges::Plan(Ranges::View(in), Ranges::View(out), Estimate);
+
+  auto i = 0;
+  for (auto spectrum : frames | views::window(hann) |
+                           views::rfft(chunk, Estimate) | views::power) {
+    std::ranges::transform(frames[i], hann, in.begin(), std::multiplies<>());
+    plan.Execute();
+    auto expected = vector<Real>(out.size());
+    std::ranges::transform(out, expected.begin(),
+                           [](auto z) { return std::norm(z); });
+    auto values = vector<Real>(spectrum.begin(), spectrum.end());
+    if (!CheckValues(values, expected, static_cast<Real>(1))) return false;
+    i++;
+  }
+  return i == count;
+}
+
+// Checks that each frame is dereferenced once, including the first, whose
+// size sets that of the transforms.
+template <NumericConcepts::Real Real>
+auto TestFrameReads(int chunk) {
+  using namespace FFTWpp;
+  auto n = 16;
+  auto count = 10;
+  auto frames = std::vector<vector<Real>>(count, vector<Real>(n));
+  for (auto& frame : frames) RandomiseValues(frame);
+  auto reads = 0;
+  auto counted = frames | std::views::transform([&](const auto& frame) {
+                   reads++;
+                   return frame;
+                 });
+  auto spectra = 0;
+  for (auto spectrum : counted | views::rfft(chunk, Estimate)) {
+    if (spectrum.size() != static_cast<std::size_t>(n / 2 + 1)) return false;
+    spectra++;
+  }
+  return spectra == count && reads == count;
+}
+
+#endif
@@ -0,0 +1,232 @@
+#ifndef FFTWPP_TESTCACHE_GUARD_H
+#define FFTWPP_TESTCACHE_GUARD_H
+
+#include <FFTWpp/Ranges>
+#include <atomic>
+#include <complex>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+// Checks that plans returned by GenerateWisdom transform arrays and can be
+// shared through a cache.
+template <NumericConcepts::Real Real>
+auto TestGenerateWisdom() {
+  using namespace FFTWpp;
+  using Complex = std::complex<Real>;
+  auto n = std::vector{8, 6};
+  auto inLayout = Ranges::Layout(n[0], n[1]);
+  auto outLayout = Ranges::Layout(n[0], n[1] / 2 + 1);
+  auto [forward, backward] =
+      GenerateWisdom<Real, Complex>(inLayout, outLayout, Estimate);
+
+  auto cache = PlanCache();
+  cache.Insert(forward);
+  cache.Insert(backward);
+  if (cache.Size() != 2) return false;
+  if (cache.Get<Real, Complex>(inLayout, outLayout, Estimate) != forward) {
+    return false;
+  }
+
+  auto in = vector<Real>(inLayout.size());
+  auto copy = in;
+  auto out = vector<Complex>(outLayout.size());
+  RandomiseValues(in);
+  forward->Execute(std::span(in), std::span(out));
+  backward->Execute(std::span(out), std::span(copy));
+  return CheckValues(in, copy, backward->Get().Normalisation());
+}
+
+// Checks that a manifest is read, and its plans made and warmed, with
+// invalid lines and plans without wisdom reported.
+inline auto TestWarmUp() {
+  using namespace FFTWpp;
+  auto manifest = std::string("TestWarmUp.manifest");
+  {
+    auto file = std::ofstream(manifest);
+    file << "# transform precision dimensions howMany arrangement flag\n"
+         << "c2c double 16x8 4 contiguous estimate forward\n"
+         << "c2c double 16x8 4 contiguous estimate backward\n"
+         << "r2c float 32 3 padded estimate\n"
+         << "c2r longdouble 12 2 interleaved estimate\n"
+         << "\n"
+         << "r2r double 8x4 2 contiguous estimate redft10 rodft10\n"
+         << "c2c double 16x8 4 contiguous estimate forward\n";
+  }
+  auto cache = PlanCache();
+  auto pool = ThreadPool(2);
+  auto report =
+      WarmUp(manifest, cache, WarmUpOptions{.executes = 2, .pool = &pool});
+  if (!report.Ready() || report.plans.size() != 6) return false;
+  if (cache.Size() != 5) return false;
+  if (report.plans[0].key != report.plans[5].key) return false;
+  for (const auto& plan : report.plans) {
+    if (!cache.Contains(plan.key)) return false;
+  }
+
+  {
+    auto file = std::ofstream(manifest);
+    file << "c2c double 16x8 4 contiguous estimate sideways\n"
+         << "r2c float 0 1 contiguous estimate\n"
+         << "c2c double 37x3 5 contiguous wisdomonly forward\n";
+  }
+  report = WarmUp(manifest, cache);
+  std::remove(manifest.c_str());
+  if (report.Ready() || report.plans.size() != 3) return false;
+  if (report.plans[2].ready || report.plans[2].error.empty()) return false;
+  return ParseManifestLine("r2r float 8 1 contiguous measure dht").has_value();
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+// Prepares a plan and pooled arrays, then forks and checks in the child
+// that the plan is taken from the cache without re-planning, that the new
+// thread pool runs tasks, and that the plan gives the correct results.
+// Nested loops on the pool are checked first.
+inline auto TestForkPreparation() {
+  using namespace FFTWpp;
+  using Complex = std::complex<double>;
+  auto manifest = std::string("TestForkPreparation.manifest");
+  {
+    auto file = std::ofstream(manifest);
+    file << "c2c double 64 4 contiguous estimate forward\n";
+  }
+  auto [in, out] = Ranges::Arrange<Complex, Complex>(Arrangement::Contiguous,
+                                                     {64}, 4);
+  auto preparation = ForkPreparation(
+      ForkOptions{.manifest = manifest,
+                  .threads = 2,
+                  .bufferBytes = in.size() * sizeof(Complex),
+                  .buffers = 2});
+  std::remove(manifest.c_str());
+  if (!preparation.Ready() || preparation.Forked()) return false;
+  // Loops nested within a worker, as fftw3's are when executes run on the
+  // pool, complete on that worker.
+  auto nested = std::atomic<int>{0};
+  preparation.Pool().ParallelFor(3, [&](int) {
+    preparation.Pool().ParallelFor(2, [&](int) { nested++; });
+  });
+  if (nested != 6) return false;
+
+  auto pid = fork();
+  if (pid < 0) return false;
+  if (pid == 0) {
+    auto& cache = preparation.Cache();
+    auto plan = cache.Get<Complex, Complex>(in, out, Estimate, Forward);
+    auto passed = preparation.Forked() && cache.Size() == 1;
+    auto count = std::atomic<int>{0};
+    preparation.Pool().ParallelFor(8, [&](int) { count++; });
+    passed = passed && count == 8;
+    auto& buffers = preparation.Buffers();
+    auto x = buffers.Acquire<Complex>(in.size());
+    auto y = buffers.Acquire<Complex>(out.size());
+    auto copy = vector<Complex>(out.size());
+    RandomiseValues(x);
+    auto direct = Ranges::Plan(Ranges::View(x, in), Ranges::View(copy, out),
+                               Estimate, Forward);
+    direct.Execute();
+    plan->Execute(x, y);
+    auto expected = std::span(copy.data(), copy.size());
+    passed = passed && CheckValues(y, expected, 1.0);
+    buffers.Release(x.data());
+    buffers.Release(y.data());
+    _exit(passed && buffers.Available() == 2 ? 0 : 1);
+  }
+  auto status = 0;
+  if (waitpid(pid, &status, 0) != pid) return false;
+  return WIFEXITED(status) && WEXITSTATUS(status) == 0 &&
+         !preparation.Forked();
+}
+#endif
+
+// Checks that arrays are attributed to their type and tag, including after
+// moves and copy assignments, and released under the same tag.
+inline auto TestMemoryAccounting() {
+  using namespace FFTWpp;
+  using Complex = std::complex<double>;
+  auto before = AllocatorMemory();
+  auto bytes = [](const auto& accounts, const std::string& name) {
+    auto it = accounts.find(name);
+    return it == accounts.end() ? std::size_t{0} : it->second.bytes;
+  };
+  {
+    auto tag = ScopedMemoryTag("TestMemoryAccounting");
+    auto a = vector<Complex>(100);
+    auto b = vector<Complex>();
+    {
+      auto inner = ScopedMemoryTag("TestMemoryAccountingInner");
+      b = vector<Complex>(50);
+    }
+    b = std::move(a);
+    auto usage = AllocatorMemory();
+    if (bytes(usage.tags, "TestMemoryAccounting") != 100 * sizeof(Complex)) {
+      return false;
+    }
+    if (bytes(usage.tags, "TestMemoryAccountingInner") != 0) return false;
+    if (bytes(usage.types, "complex<double>") !=
+        bytes(before.types, "complex<double>") + 100 * sizeof(Complex)) {
+      return false;
+    }
+  }
+  {
+    auto a = vector<double>(100, Allocator<double>("TestMemoryAccountingA"));
+    auto b = vector<double>(10, Allocator<double>("TestMemoryAccountingB"));
+    a = b;
+    auto usage = AllocatorMemory();
+    if (bytes(usage.tags, "TestMemoryAccountingA") != 100 * sizeof(double) ||
+        bytes(usage.tags, "TestMemoryAccountingB") != 10 * sizeof(double)) {
+      return false;
+    }
+  }
+  auto after = AllocatorMemory();
+  return bytes(after.tags, "TestMemoryAccounting") == 0 &&
+         bytes(after.tags, "TestMemoryAccountingA") == 0 &&
+         bytes(after.tags, "TestMemoryAccountingB") == 0 &&
+         after.total.bytes == before.total.bytes;
+}
+
+// Checks that the least recently used plans are evicted to meet a budget,
+// along with their memory records.
+inline auto TestCacheBudget() {
+  using namespace FFTWpp;
+  using Complex = std::complex<double>;
+  auto cache = PlanCache();
+  auto get = [&](int n) {
+    return cache.Get<Complex, Complex>(Ranges::Layout(n), Ranges::Layout(n),
+                                       Estimate, Forward);
+  };
+  auto first = get(64);
+  auto second = get(128);
+  auto third = get(256);
+  if (cache.Size() != 3 || cache.Bytes() < first->ArrayBytes() +
+                                               second->ArrayBytes() +
+                                               third->ArrayBytes()) {
+    return false;
+  }
+  auto memory = PlanMemory::Get().Bytes();
+  if (!memory.contains(first->Key())) return false;
+
+  // Use the first plan again so that the second is the least recent.
+  get(64);
+  cache.SetBudget(cache.Bytes() - 1);
+  if (cache.Size() != 2 || cache.Evictions() != 1) return false;
+  if (cache.Contains(second->Key()) || !cache.Contains(first->Key())) {
+    return false;
+  }
+  if (PlanMemory::Get().Bytes().contains(second->Key())) return false;
+  cache.SetBudget(1);
+  if (cache.Size() != 1 || !cache.Contains(first->Key())) return false;
+
+  // Evicted plans remain usable by their holders.
+  auto in = vector<Complex>(128);
+  auto out = vector<Complex>(128);
+  second->Execute(std::span(in), std::span(out));
+  return cache.Bytes() == cache.BytesByKey().at(first->Key());
+}
+
+#endif  // FFTWPP_TESTCACHE_GUARD_H
@@ -0,0 +1,451 @@
+#ifndef FFTWPP_TESTEXECUTE_GUARD_H
+#define FFTWPP_TESTEXECUTE_GUARD_H
+
+#include <FFTWpp/Ranges>
+#include <algorithm>
+#include <complex>
+#include <execution>
+#include <random>
+#include <ranges>
+#include <span>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Executes a C2C plan on a batch of independent buffer pairs, the last of
+// which has its input offset by one element, and checks the results
+// against separate new-array executes.
+template <NumericConcepts::Real Real>
+auto TestExecutePairs(bool parallel) {
+  using namespace FFTWpp;
+  using Complex = std::complex<Real>;
+  std::random_device rd;
+  std::mt19937 gen(rd());
+  std::uniform_int_distribution<> d(10, 100);
+  int n = d(gen);
+  int count = d(gen);
+  auto in = vector<Complex>(n);
+  auto out = vector<Complex>(n);
+  auto plan =
+      Ranges::Plan(Ranges::View(in), Ranges::View(out), Estimate, Forward);
+  auto ins = std::vector<vector<Complex>>(count, vector<Complex>(n));
+  auto outs = std::vector<vector<Complex>>(count, vector<Complex>(n));
+  auto copies = std::vector<vector<Complex>>(count, vector<Complex>(n));
+  auto pairs = std::vector<std::pair<Complex*, Complex*>>();
+  for (auto i = 0; i < count; i++) {
+    RandomiseValues(ins[i]);
+    pairs.emplace_back(ins[i].data(), outs[i].data());
+  }
+  auto shifted = vector<Complex>(n + 1);
+  std::ranges::copy(ins.back(), shifted.begin() + 1);
+  pairs.back().first = shifted.data() + 1;
+  auto pool = ThreadPool(4);
+  plan.Execute(pairs, parallel ? &pool : nullptr);
+  auto misaligned = AlignmentOf(shifted.data() + 1) != AlignmentOf(in.data());
+  if (plan.Fallbacks() != (misaligned ? 1 : 0)) return false;
+  for (auto i = 0; i < count; i++) {
+    plan.Execute(std::ranges::views::all(ins[i]),
+                 std::ranges::views::all(copies[i]));
+    if (!CheckValues(outs[i], copies[i], static_cast<Real>(1))) return false;
+  }
+  return true;
+}
+
+// Executes an R2C plan on input offset by one element from an aligned
+// allocation, checking that the unaligned plan is made on demand and gives
+// the same results as executing on aligned data.
+template <NumericConcepts::Real Real>
+auto TestUnaligned() {
+  using namespace FFTWpp;
+  using Complex = std::complex<Real>;
+  std::random_device rd;
+  std::mt19937 gen(rd());
+  std::uniform_int_distribution<> d(10, 100);
+  int n = d(gen);
+  auto in = vector<Real>(n);
+  auto out = vector<Complex>(n / 2 + 1);
+  auto copy = vector<Complex>(n / 2 + 1);
+  auto plan = Ranges::Plan(Ranges::View(in), Ranges::View(out), Measure);
+  auto shifted = vector<Real>(n + 1);
+  RandomiseValues(shifted);
+  std::ranges::copy(shifted | std::views::drop(1), in.begin());
+  plan.Execute(std::span(shifted.data() + 1, n), std::span(out));
+  if (plan.Fallbacks() != 1) return false;
+  plan.Execute(std::span(in), std::span(copy));
+  if (plan.Fallbacks() != 1) return false;
+  return CheckValues(out, copy, static_cast<Real>(1));
+}
+
+// Convolves batches of real data using the parallel algorithms, and checks
+// the results against a direct evaluation.
+template <NumericConcepts::Real Real>
+auto TestConvolve() {
+  using namespace FFTWpp;
+  using Complex = std::complex<Real>;
+  std::random_device rd;
+  std::mt19937 gen(rd());
+  std::uniform_int_distribution<> d(10, 50);
+  int n = d(gen);
+  int count = d(gen);
+  auto in = vector<Real>(n);
+  auto out = vector<Complex>(n / 2 + 1);
+  auto forwardPlan =
+      Ranges::Plan(Ranges::View(in), Ranges::View(out), Estimate);
+  auto backwardPlan =
+      Ranges::Plan(Ranges::View(out), Ranges::View(in), Estimate);
+  auto lhs = std::vector<vector<Real>>(count, vector<Real>(n));
+  auto rhs = lhs;
+  auto results = lhs;
+  for (auto i = 0; i < count; i++) {
+    RandomiseValues(lhs[i]);
+    RandomiseValues(rhs[i]);
+  }
+  convolve(std::execution::par_unseq, lhs, rhs, results, forwardPlan,
+           backwardPlan);
+  for (auto i = 0; i < count; i++) {
+    auto expected = vector<Real>(n);
+    for (auto j = 0; j < n; j++) {
+      for (auto k = 0; k < n; k++) {
+        expected[j] += lhs[i][k] * rhs[i][(j - k + n) % n];
+      }
+    }
+    if (!CheckValues(results[i], expected, static_cast<Real>(1))) return false;
+  }
+  return true;
+}
+
+// Tunes a batch of C2C transforms and checks the selected plan against a
+// plan made directly, as well as a plan splitting the batch in two, whose
+// second half may be aligned differently from the first.
+template <NumericConcepts::Real Real>
+auto TestTuner(long executions, int n = 64, int howMany = 16) {
+  using namespace FFTWpp;
+  using Complex = std::complex<Real>;
+  auto layout =
+      Ranges::Layout(1, std::vector{n}, howMany, std::vector{n}, 1, n);
+  auto in = vector<Complex>(layout.size());
+  auto out = vector<Complex>(layout.size());
+  auto split = vector<Complex>(layout.size());
+  auto copy = vector<Complex>(layout.size());
+  auto tuner = Tuner("", 4);
+  auto plan = tuner.MakePlan(Ranges::View(in, layout),
+                             Ranges::View(out, layout), executions, Forward);
+  auto halves = Ranges::TunedPlan(Ranges::View(in, layout),
+                                  Ranges::View(split, layout),
+                                  Tuning{.splits = 2}, Forward);
+  auto direct = Ranges::Plan(Ranges::View(in, layout),
+                             Ranges::View(copy, layout), Estimate, Forward);
+  RandomiseValues(in);
+  plan.Execute();
+  halves.Execute();
+  direct.Execute();
+  return CheckValues(out, copy, static_cast<Real>(1)) &&
+         CheckValues(split, copy, static_cast<Real>(1));
+}
+
+// Checks that the planning advisor measures only Estimate when there are
+// no executions to pay for planning, that it recommends the flag of least
+// total cost among those measured, that repeated queries reuse its
+// measurements, and that the plan it makes is correct.
+template <NumericConcepts::Real Real>
+auto TestPlanningAdvisor() {
+  using namespace FFTWpp;
+  using Complex = std::complex<Real>;
+  auto n = 64;
+  auto in = vector<Complex>(n);
+  auto out = vector<Complex>(n);
+  auto copy = vector<Complex>(n);
+  auto layout = Ranges::Layout(n);
+  auto advisor = PlanningAdvisor({Estimate, Measure});
+  if (advisor.Advise<Complex, Complex>(layout, layout, 0, Forward)
+          .costs.size() != 1) {
+    return false;
+  }
+  for (auto executions : {1l, 1000000000l, 1l}) {
+    auto advice =
+        advisor.Advise<Complex, Complex>(layout, layout, executions, Forward);
+    if (advice.costs.empty() || advice.costs.size() > 2) return false;
+    for (const auto& cost : advice.costs) {
+      if (cost.Cost(executions) < advice.Cost()) return false;
+    }
+  }
+  if (advisor.Measurements() > 2) return false;
+  auto plan = advisor.MakePlan(Ranges::View(in), Ranges::View(out), 10,
+                               Forward);
+  if (advisor.Measurements() > 2) return false;
+  auto direct = Ranges::Plan(Ranges::View(in), Ranges::View(copy), Estimate,
+                             Forward);
+  RandomiseValues(in);
+  plan.Execute();
+  direct.Execute();
+  return CheckValues(out, copy, static_cast<Real>(1));
+}
+
+// Forces an adaptive plan to re-plan by giving it an expected time that
+// every window exceeds, and checks that its expected time is then rebased
+// and that it still gives the correct results.
+template <NumericConcepts::Real Real>
+auto TestAdaptivePlan() {
+  using namespace FFTWpp;
+  using Complex = std::complex<Real>;
+  auto n = 64;
+  auto in = vector<Complex>(n);
+  auto out = vector<Complex>(n);
+  auto copy = vector<Complex>(n);
+  auto options = AdaptiveOptions{.expectedTime = 1e-12, .window = 4,
+                                 .patience = 2, .flag = Measure};
+  auto plan = Ranges::AdaptivePlan(Ranges::View(in), Ranges::View(out),
+                                   Estimate, options, Forward);
+  auto direct = Ranges::Plan(Ranges::View(in), Ranges::View(copy), Estimate,
+                             Forward);
+  RandomiseValues(in);
+  for (auto i = 0; i < 2 * options.window; i++) plan.Execute();
+  plan.Wait();
+  if (plan.Replans() != 1 || plan.Swaps() > 1) return false;
+  for (auto i = 0; i < options.window; i++) plan.Execute();
+  if (plan.ExpectedTime() <= options.expectedTime) return false;
+  direct.Execute();
+  return CheckValues(out, copy, static_cast<Real>(1));
+}
+
+#if defined(__linux__)
+// Runs a transform service on a thread, submits several C2C jobs on data
+// in a shared buffer from a client, and checks them against direct plans,
+// that invalid jobs are rejected, and that a job at a misaligned offset is
+// transformed.
+template <NumericConcepts::Real Real>
+auto TestService() {
+  using namespace FFTWpp;
+  using Complex = std::complex<Real>;
+  auto n = 64;
+  auto jobs = 4;
+  auto path = "/tmp/FFTWpp-test-" + std::to_string(getpid()) + ".sock";
+  auto service = TransformService(path, 2);
+  if (!service.Listening()) return false;
+  auto server = std::thread([&service]() { service.Run(); });
+  auto client = TransformClient(path);
+  auto bytes = 2 * jobs * n * sizeof(Complex);
+  auto buffer = client.Allocate(bytes);
+  auto passed = client.Connected() && buffer.Valid();
+  auto layout = Ranges::Layout(1, std::vector{n}, 1, std::vector{n}, 1, n);
+  auto ids = std::vector<std::uint64_t>();
+  for (auto i = 0; passed && i < jobs; i++) {
+    auto in = buffer.Span<Complex>(2 * i * n * sizeof(Complex), n);
+    RandomiseValues(in);
+    ids.push_back(client.Submit<Complex, Complex>(
+        buffer, 2 * i * n * sizeof(Complex), layout,
+        (2 * i + 1) * n * sizeof(Complex), layout, Estimate, Forward));
+  }
+  for (auto id : ids) passed = client.Wait(id) && passed;
+  auto copy = vector<Complex>(n);
+  for (auto i = 0; passed && i < jobs; i++) {
+    auto in = buffer.Span<Complex>(2 * i * n * sizeof(Complex), n);
+    auto out = buffer.Span<Complex>((2 * i + 1) * n * sizeof(Complex), n);
+    auto direct = Ranges::Plan(Ranges::View(in), Ranges::View(copy),
+                               Estimate, Forward);
+    direct.Execute();
+    auto expected = std::span(copy.data(), copy.size());
+    passed = CheckValues(out, expected, static_cast<Real>(1));
+  }
+  // In-place and overlapping jobs are rejected, as are costly flags.
+  auto size = n * sizeof(Complex);
+  passed = passed &&
+           !client.Transform<Complex, Complex>(buffer, 0, layout, 0, layout,
+                                               Estimate, Forward) &&
+           !client.Transform<Complex, Complex>(buffer, 0, layout, size / 2,
+                                               layout, Estimate, Forward) &&
+           !client.Transform<Complex, Complex>(buffer, 0, layout, size,
+                                               layout, Patient, Forward);
+  // A job at an offset whose alignment differs from that of the planning
+  // arrays uses the unaligned plan.
+  auto realLayout = Ranges::Layout(n);
+  auto reals = buffer.Span<Real>(sizeof(Real), n);
+  RandomiseValues(reals);
+  passed = passed && client.Transform<Real, Real>(
+                         buffer, sizeof(Real), realLayout, size + sizeof(Real),
+                         realLayout, Estimate, REDFT10);
+  auto realCopy = vector<Real>(reals.begin(), reals.end());
+  auto realExpected = vector<Real>(n);
+  auto realPlan = Ranges::Plan(Ranges::View(realCopy),
+                               Ranges::View(realExpected), Estimate, REDFT10);
+  realPlan.Execute();
+  passed = passed && CheckValues(buffer.Span<Real>(size + sizeof(Real), n),
+                                 std::span(realExpected), static_cast<Real>(1));
+  client.Release(buffer);
+  service.Stop();
+  server.join();
+  return passed && service.Jobs() == jobs + 1;
+}
+#endif
+
+// Prepares a C2R plan for real-time use and checks that its input is
+// restored, that the outliers reported are those slower than the given
+// multiple of the median, and that the plan still gives the correct
+// results. The arrays are unlocked afterwards.
+template <NumericConcepts::Real Real>
+auto TestPrepareRealTime() {
+  using namespace FFTWpp;
+  using Complex = std::complex<Real>;
+  auto n = 64;
+  auto in = vector<Complex>(n / 2 + 1);
+  auto out = vector<Real>(n);
+  auto plan = Ranges::Plan(Ranges::View(in), Ranges::View(out), Measure);
+  auto inverse = Ranges::Plan(Ranges::View(out), Ranges::View(in), Estimate);
+  RandomiseValues(out);
+  auto expected = out;
+  inverse.Execute();
+  auto copy = in;
+  auto pool = ThreadPool(2);
+  auto options = RealTimeOptions{.warmUps = 20, .cores = {0}};
+  auto report = PrepareRealTime(plan, options, &pool);
+  auto passed = in == copy && report.median > 0 &&
+                report.max >= report.median &&
+                std::cmp_less_equal(2 * report.outliers.size(),
+                                    options.warmUps) &&
+                std::ranges::all_of(report.outliers, [&](auto time) {
+                  return time > options.outlierFactor * report.median &&
+                         time <= report.max;
+                });
+  plan.Execute();
+  passed = passed && CheckValues(expected, out, plan.Normalisation());
+  if (report.locked) {
+    UnlockMemory(in.data(), in.size() * sizeof(Complex));
+    UnlockMemory(out.data(), out.size() * sizeof(Real));
+  }
+  return passed;
+}
+
+// Checks that flushing of subnormals is scoped to executes, and that the
+// results are unaffected for normal data.
+template <NumericConcepts::Real Real>
+auto TestFlushDenormals() {
+  using namespace FFTWpp;
+  using Complex = std::complex<Real>;
+  auto n = 32;
+  auto in = vector<Complex>(n);
+  auto out = vector<Complex>(n);
+  auto copy = vector<Complex>(n);
+  auto plan =
+      Ranges::Plan(Ranges::View(in), Ranges::View(out), Estimate, Forward);
+  RandomiseValues(in);
+  plan.Execute(std::span(in), std::span(copy));
+  auto before = DenormalState();
+  {
+    auto state = ScopedDenormalState(true);
+    if (HasDenormalControl && DenormalState() == before) return false;
+  }
+  if (DenormalState() != before) return false;
+  plan.SetFlushDenormals(true);
+  plan.Execute();
+  auto pairs = std::vector<std::pair<Complex*, Complex*>>{{in.data(),
+                                                            out.data()}};
+  auto pool = ThreadPool(2);
+  plan.Execute(pairs, &pool);
+  if (DenormalState() != before) return false;
+  return CheckValues(out, copy, static_cast<Real>(1));
+}
+
+// Checks that subnormal outputs are counted when sampling is enabled, and
+// that padding between the outputs of a batch is not sampled.
+template <NumericConcepts::Real Real>
+auto TestSubnormalSampling() {
+  using namespace FFTWpp;
+  auto n = 16;
+  auto in = vector<Real>(n);
+  auto out = vector<Real>(n);
+  auto plan = Ranges::Plan(Ranges::View(in), Ranges::View(out), Estimate,
+                           REDFT10);
+  std::ranges::fill(in, std::numeric_limits<Real>::min() / 64);
+  plan.Execute();
+  if (plan.SampleCount() != 0) return false;
+  plan.SetSubnormalSampling(2);
+  plan.Execute();
+  if (plan.SampleCount() != n / 2) return false;
+  if (plan.SubnormalCount() == 0) return false;
+  std::ranges::fill(in, 1);
+  auto count = plan.SubnormalCount();
+  plan.Execute();
+  if (plan.SubnormalCount() != count || plan.SampleCount() != n) return false;
+
+  // Padding between the transforms of a batch is not sampled.
+  auto inLayout = Ranges::Layout(1, std::vector{n}, 2, std::vector{n}, 1, n);
+  auto outLayout =
+      Ranges::Layout(1, std::vector{n}, 2, std::vector{n + 4}, 1, n + 4);
+  auto batch = vector<Real>(inLayout.size(), 1);
+  auto padded = vector<Real>(outLayout.size());
+  auto batchPlan = Ranges::Plan(Ranges::View(batch, inLayout),
+                                Ranges::View(padded, outLayout), Estimate,
+                                REDFT10);
+  std::ranges::fill(padded, std::numeric_limits<Real>::min() / 64);
+  batchPlan.SetSubnormalSampling(1);
+  batchPlan.Execute();
+  return batchPlan.SampleCount() == 2 * n && batchPlan.SubnormalCount() == 0;
+}
+
+// Checks that a preserved input to a 2D C2R plan is copied to a scratch
+// array and left unchanged, that a consumable input is planned without a
+// copy, and that both give the same output. A 1D C2R input preserved only
+// through the planning flag is left to fftw3 and not copied.
+template <NumericConcepts::Real Real>
+auto TestInputOwnership() {
+  using namespace FFTWpp;
+  using Complex = std::complex<Real>;
+  auto n = std::vector{12, 10};
+  auto [inSize, outSize] = DataSize<Complex, Real>(n[0], n[1]);
+  auto in = vector<Complex>(inSize);
+  auto out = vector<Real>(outSize);
+  auto consumed = vector<Complex>(inSize);
+  auto consumedOut = vector<Real>(outSize);
+  auto inView = Ranges::View(in, n[0], n[1] / 2 + 1);
+  auto preserved = Ranges::Plan(inView.Preserved(),
+                                Ranges::View(out, n[0], n[1]), Estimate);
+  auto consumable = Ranges::Plan(
+      Ranges::View(consumed, n[0], n[1] / 2 + 1).Consumable(),
+      Ranges::View(consumedOut, n[0], n[1]), Estimate);
+  if (!preserved.CopiesInput() || consumable.CopiesInput()) return false;
+  auto line = vector<Complex>(n[1] / 2 + 1);
+  auto lineOut = vector<Real>(n[1]);
+  auto native = Ranges::Plan(Ranges::View(line), Ranges::View(lineOut),
+                             Estimate | PreserveInput);
+  if (native.CopiesInput()) return false;
+
+  auto forward = Ranges::Plan(Ranges::View(out, n[0], n[1]), inView, Estimate);
+  RandomiseValues(out);
+  forward.Execute();
+  auto copy = in;
+  consumed = in;
+  preserved.Execute();
+  consumable.Execute();
+  if (!std::ranges::equal(in, copy)) return false;
+  return CheckValues(out, consumedOut, static_cast<Real>(1));
+}
+
+// Checks the relative error of a C2C round trip against the precision, and
+// that of a scaled copy against the scaling.
+template <NumericConcepts::Real Real>
+auto TestRelativeError() {
+  using namespace FFTWpp;
+  using Complex = std::complex<Real>;
+  auto n = 64;
+  auto in = vector<Complex>(n);
+  auto out = vector<Complex>(n);
+  auto back = vector<Complex>(n);
+  auto forward =
+      Ranges::Plan(Ranges::View(in), Ranges::View(out), Estimate, Forward);
+  auto backward =
+      Ranges::Plan(Ranges::View(out), Ranges::View(back), Estimate, Backward);
+  RandomiseValues(in);
+  forward.Execute();
+  backward.Execute();
+  auto epsilon = std::numeric_limits<Real>::epsilon();
+  if (RelativeError(in, back, backward.Normalisation()) > 100 * epsilon) {
+    return false;
+  }
+  auto scaled = in;
+  for (auto& x : scaled) x *= static_cast<Real>(1.001);
+  auto error = RelativeError(in, scaled, 1);
+  return std::abs(error - 1e-3) < 1e-5;
+}
+
+#endif
@@ -0,0 +1,60 @@
+#ifndef FFTWPP_TESTFIXED_GUARD_H
+#define FFTWPP_TESTFIXED_GUARD_H
+
+#include <FFTWpp/Ranges>
+#include <complex>
+#include <random>
+#include <ranges>
+
+// Compares a FixedPlan with a Ranges::Plan for a batch of transforms with
+// the given compile-time dimensions.
+template <NumericConcepts::RealOrComplex InType,
+          NumericConcepts::RealOrComplex OutType, int... Ns>
+auto TestFixed(FFTWpp::RealKind kind = FFTWpp::REDFT10) {
+  using namespace FFTWpp;
+  std::random_device rd;
+  std::mt19937 gen(rd());
+  std::uniform_int_distribution<> d(1, 20);
+  int howMany = d(gen);
+  auto [inSize, outSize] = DataSize<InType, OutType>(Ns...);
+  auto realN = std::vector{Ns...};
+  auto complexN = realN;
+  if constexpr (!std::same_as<InType, OutType>) {
+    complexN.back() = complexN.back() / 2 + 1;
+  }
+  auto& inN = NumericConcepts::Real<InType> ? realN : complexN;
+  auto& outN = NumericConcepts::Real<OutType> ? realN : complexN;
+  auto rank = static_cast<int>(sizeof...(Ns));
+  auto inLayout = Ranges::Layout(rank, inN, howMany, inN, 1, inSize);
+  auto outLayout = Ranges::Layout(rank, outN, howMany, outN, 1, outSize);
+  auto in = vector<InType>(inLayout.size());
+  auto out = vector<OutType>(outLayout.size());
+  auto copy = vector<OutType>(outLayout.size());
+  auto inView = Ranges::View(in, inLayout);
+  auto outView = Ranges::View(out, outLayout);
+  auto copyView = Ranges::View(copy, outLayout);
+  RandomiseValues(in);
+  if constexpr (NumericConcepts::Complex<InType> &&
+                NumericConcepts::Complex<OutType>) {
+    auto fixed = Ranges::MakeFixedPlan<Ns...>(inView, outView, Estimate,
+                                              Forward);
+    auto plan = Ranges::Plan(inView, copyView, Estimate, Forward);
+    fixed.Execute();
+    plan.Execute();
+  } else if constexpr (NumericConcepts::Real<InType> &&
+                       NumericConcepts::Real<OutType>) {
+    auto fixed = Ranges::MakeFixedPlan<Ns...>(inView, outView, Estimate, kind);
+    auto plan = Ranges::Plan(inView, copyView, Estimate, kind);
+    fixed.Execute();
+    plan.Execute();
+  } else {
+    auto fixed = Ranges::MakeFixedPlan<Ns...>(inView, outView, Estimate);
+    auto plan = Ranges::Plan(inView, copyView, Estimate);
+    fixed.Execute();
+    plan.Execute();
+  }
+  using Real = NumericConcepts::RemoveComplex<InType>;
+  return CheckValues(out, copy, static_cast<Real>(1));
+}
+
+#endif
@@ -0,0 +1,147 @@
+#ifndef FFTWPP_TESTINSTRUMENTATION_GUARD_H
+#define FFTWPP_TESTINSTRUMENTATION_GUARD_H
+
+#include <FFTWpp/Ranges>
+#include <atomic>
+#include <cmath>
+#include <complex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "RealTimeHooks.h"
+
+// Checks that counted executes are grouped by plan key, and that reports
+// are made whether or not the hardware counters are available. Counts can
+// be zero if the counter group was never scheduled, so only their ratios
+// are checked.
+template <NumericConcepts::Real Real>
+auto TestCounterProfiler() {
+  using namespace FFTWpp;
+  using Complex = std::complex<Real>;
+  auto in = vector<Complex>(64);
+  auto out = vector<Complex>(64);
+  auto half = vector<Complex>(64 / 2 + 1);
+  auto real = vector<Real>(64);
+  auto forward =
+      Ranges::Plan(Ranges::View(in), Ranges::View(out), Estimate, Forward);
+  auto backward = Ranges::Plan(Ranges::View(half, 64 / 2 + 1),
+                               Ranges::View(real), Estimate);
+  auto profiler = CounterProfiler();
+  for (auto i = 0; i < 3; i++) profiler.Execute(forward);
+  profiler.Execute(backward);
+
+  auto reports = profiler.Reports();
+  if (reports.size() != 2) return false;
+  for (const auto& report : reports) {
+    auto executes = report.key == forward.Key() ? 3 : 1;
+    if (report.executes != executes || report.flops <= 0) return false;
+    if (report.available != CounterProfiler::Available()) return false;
+    if (!std::isfinite(report.IPC()) || !std::isfinite(report.MissRate())) {
+      return false;
+    }
+    if (!report.available && report.IPC() != 0) return false;
+  }
+  return NominalFlops(forward) == 5 * 64 * 6;
+}
+
+// Checks that planning and executes, including those on pool workers, are
+// traced when enabled and written as Chrome trace JSON, that nothing is
+// recorded when disabled, and that threads claim their buffers in real time.
+template <NumericConcepts::Real Real>
+auto TestTracer() {
+  using namespace FFTWpp;
+  using Complex = std::complex<Real>;
+  auto& tracer = Tracer::Get();
+  tracer.Clear();
+  auto in = vector<Complex>(32);
+  auto out = vector<Complex>(32);
+  auto plan =
+      Ranges::Plan(Ranges::View(in), Ranges::View(out), Estimate, Forward);
+  plan.Execute();
+  if (tracer.Recorded() != 0) return false;
+
+  tracer.Enable();
+  auto traced =
+      Ranges::Plan(Ranges::View(in), Ranges::View(out), Estimate, Backward);
+  traced.Execute();
+  auto ins = std::vector<vector<Complex>>(8, vector<Complex>(32));
+  auto outs = std::vector<vector<Complex>>(8, vector<Complex>(32));
+  auto pairs = std::vector<std::pair<Complex*, Complex*>>();
+  for (auto i = 0; i < 8; i++) {
+    pairs.emplace_back(ins[i].data(), outs[i].data());
+  }
+  {
+    // The pool is joined here so that its workers are idle in the region
+    // below.
+    auto pool = ThreadPool(2);
+    traced.Execute(pairs, &pool);
+  }
+  tracer.Disable();
+
+  // Planning, the direct execute, the batch and its eight executes, and the
+  // allocations of the arrays.
+  if (tracer.Recorded() < 11 || tracer.Dropped() != 0) return false;
+  auto stream = std::ostringstream();
+  tracer.Write(stream);
+  auto json = stream.str();
+  tracer.Clear();
+
+  // A new thread claims a buffer made by Enable without allocating or
+  // locking. The thread records only within the region, and exits after
+  // it, since thread exit frees memory.
+  tracer.Enable(1 << 10, 4);
+  auto stage = std::atomic<int>(0);
+  auto thread = std::thread([&]() {
+    while (stage.load() != 1) {
+    }
+    { auto trace = ScopedTrace("Claim", "test"); }
+    stage.store(2);
+    while (stage.load() != 3) {
+    }
+  });
+  auto claimed = false;
+  {
+    auto region = RealTimeRegion();
+    stage.store(1);
+    while (stage.load() != 2) {
+    }
+    claimed = region.Violations().None();
+  }
+  stage.store(3);
+  thread.join();
+  tracer.Disable();
+  claimed = claimed && tracer.Recorded() == 1;
+  tracer.Clear();
+
+  return claimed && json.starts_with("{\"displayTimeUnit\"") &&
+         json.find("\"name\":\"Plan\"") != std::string::npos &&
+         json.find("\"name\":\"ExecuteBatch\"") != std::string::npos &&
+         json.find("\"name\":\"Allocate\"") != std::string::npos &&
+         json.find(traced.Key()) != std::string::npos &&
+         json.ends_with("]}\n");
+}
+
+// Checks the operations counted by fftw3 and the bytes touched by R2C and
+// C2C plans.
+template <NumericConcepts::Real Real>
+auto TestFlops() {
+  using namespace FFTWpp;
+  using Complex = std::complex<Real>;
+  auto n = 64;
+  auto real = vector<Real>(n);
+  auto in = vector<Complex>(n);
+  auto out = vector<Complex>(n);
+  auto half = vector<Complex>(n / 2 + 1);
+  auto complex =
+      Ranges::Plan(Ranges::View(in), Ranges::View(out), Estimate, Forward);
+  auto r2c = Ranges::Plan(Ranges::View(real), Ranges::View(half, n / 2 + 1),
+                          Estimate);
+  if (complex.Flops() <= 0 || r2c.Flops() <= 0) return false;
+  return TouchedBytes(complex) == 2 * n * sizeof(Complex) &&
+         TouchedBytes(r2c) == n * sizeof(Real) + (n / 2 + 1) * sizeof(Complex);
+}
+
+#endif  // FFTWPP_TESTINSTRUMENTATION_GUARD_H
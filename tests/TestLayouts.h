@@ -0,0 +1,240 @@
+#ifndef FFTWPP_TESTLAYOUTS_GUARD_H
+#define FFTWPP_TESTLAYOUTS_GUARD_H
+
+#include <FFTWpp/Ranges>
+#include <complex>
+#include <random>
+#include <span>
+#include <vector>
+
+// Reorders a batch through each arrangement and back, checking that the
+// values are unchanged.
+template <NumericConcepts::RealOrComplex T>
+auto TestReorder(std::vector<int> n) {
+  using namespace FFTWpp;
+  std::random_device rd;
+  std::mt19937 gen(rd());
+  std::uniform_int_distribution<> d(1, 40);
+  int howMany = d(gen);
+  auto contiguous = Ranges::Arrange(Arrangement::Contiguous, n, howMany);
+  auto interleaved = Ranges::Arrange(Arrangement::Interleaved, n, howMany);
+  auto padded = Ranges::Arrange(Arrangement::Padded, n, howMany, 3);
+  auto a = vector<T>(contiguous.size());
+  auto b = vector<T>(interleaved.size());
+  auto c = vector<T>(padded.size());
+  auto copy = vector<T>(contiguous.size());
+  RandomiseValues(a);
+  Ranges::Reorder(Ranges::View(a, contiguous), Ranges::View(b, interleaved));
+  Ranges::Reorder(Ranges::View(b, interleaved), Ranges::View(c, padded));
+  Ranges::Reorder(Ranges::View(c, padded), Ranges::View(copy, contiguous));
+  return a == copy;
+}
+
+// Checks that the advised layouts are those of the advised arrangement,
+// that data reordered into them and back is unchanged, and that a batch
+// transformed in them matches the contiguous layout.
+template <NumericConcepts::RealOrComplex InType,
+          NumericConcepts::RealOrComplex OutType, typename... Args>
+auto TestAdviseLayout(std::vector<int> n, int howMany, Args... args) {
+  using namespace FFTWpp;
+  using Real = NumericConcepts::RemoveComplex<InType>;
+  auto advice = AdviseLayout<InType, OutType>(n, howMany, Estimate, args...);
+  auto [arrangedIn, arrangedOut] =
+      Ranges::Arrange<InType, OutType>(advice.arrangement, n, howMany);
+  if (advice.in != arrangedIn || advice.out != arrangedOut) return false;
+  auto inLayout = Ranges::Arrange(
+      Arrangement::Contiguous,
+      std::vector<int>(advice.in.N().begin(), advice.in.N().end()), howMany);
+  auto outLayout = Ranges::Arrange(
+      Arrangement::Contiguous,
+      std::vector<int>(advice.out.N().begin(), advice.out.N().end()), howMany);
+  auto in = vector<InType>(inLayout.size());
+  auto out = vector<OutType>(outLayout.size());
+  auto advisedIn = vector<InType>(advice.in.size());
+  auto advisedOut = vector<OutType>(advice.out.size());
+  auto copy = vector<OutType>(outLayout.size());
+  auto inCopy = vector<InType>(inLayout.size());
+  auto plan = Ranges::Plan(Ranges::View(in, inLayout),
+                           Ranges::View(out, outLayout), Estimate, args...);
+  auto advised = Ranges::Plan(Ranges::View(advisedIn, advice.in),
+                              Ranges::View(advisedOut, advice.out), Estimate,
+                              args...);
+  RandomiseValues(in);
+  Ranges::Reorder(Ranges::View(in, inLayout),
+                  Ranges::View(advisedIn, advice.in));
+  Ranges::Reorder(Ranges::View(advisedIn, advice.in),
+                  Ranges::View(inCopy, inLayout));
+  if (in != inCopy) return false;
+  plan.Execute();
+  advised.Execute();
+  Ranges::Reorder(Ranges::View(advisedOut, advice.out),
+                  Ranges::View(copy, outLayout));
+  return CheckValues(out, copy, static_cast<Real>(1));
+}
+
+// Transforms an array with padded embed dimensions and checks the results
+// against the packed array.
+template <NumericConcepts::RealOrComplex InType,
+          NumericConcepts::RealOrComplex OutType, typename... Args>
+auto TestPadded(std::vector<int> n, Args... args) {
+  using namespace FFTWpp;
+  using Real = NumericConcepts::RemoveComplex<InType>;
+  auto rank = static_cast<int>(n.size());
+  auto complexN = n;
+  if constexpr (!std::same_as<InType, OutType>) {
+    complexN.back() = complexN.back() / 2 + 1;
+  }
+  auto inN = NumericConcepts::Real<InType> ? n : complexN;
+  auto outN = NumericConcepts::Real<OutType> ? n : complexN;
+  auto pad = Ranges::Pad::CacheLine<InType>();
+  auto inLayout = Ranges::Layout(rank, inN, 1, inN, 1, 0);
+  auto outLayout = Ranges::Layout(rank, outN, 1, outN, 1, 0);
+  auto paddedIn =
+      Ranges::Layout(rank, inN, 1, Ranges::PaddedEmbed(pad, inN), 1, 0);
+  auto paddedOut =
+      Ranges::Layout(rank, outN, 1, Ranges::PaddedEmbed(pad, outN), 1, 0);
+  auto in = Ranges::Allocate<InType>(inLayout);
+  auto out = Ranges::Allocate<OutType>(outLayout);
+  auto padIn = Ranges::Allocate<InType>(paddedIn);
+  auto padOut = Ranges::Allocate<OutType>(paddedOut);
+  auto copy = Ranges::Allocate<OutType>(outLayout);
+  auto plan = Ranges::Plan(Ranges::View(in, inLayout),
+                           Ranges::View(out, outLayout), Estimate, args...);
+  auto padded = Ranges::Plan(Ranges::View(padIn, paddedIn),
+                             Ranges::View(padOut, paddedOut), Estimate,
+                             args...);
+  RandomiseValues(in);
+  Ranges::Reorder(Ranges::View(in, inLayout), Ranges::View(padIn, paddedIn));
+  plan.Execute();
+  padded.Execute();
+  Ranges::Reorder(Ranges::View(padOut, paddedOut),
+                  Ranges::View(copy, outLayout));
+  return CheckValues(out, copy, static_cast<Real>(1));
+}
+
+// Checks the padded layout constructor and data sizes agree.
+template <NumericConcepts::RealOrComplex InType,
+          NumericConcepts::RealOrComplex OutType>
+auto TestPaddedSize() {
+  using namespace FFTWpp;
+  auto pad = Ranges::Pad{3};
+  auto [inSize, outSize] = DataSize<InType, OutType>(pad, 4, 6, 8);
+  auto layout = Ranges::Layout(pad, 4, 6, 8);
+  auto in = vector<InType>(inSize);
+  auto view = Ranges::View(in, pad, 4, 6, 8);
+  auto expected = NumericConcepts::Real<OutType> ? 4 * 9 * 11 : 4 * 9 * 8;
+  return inSize == 4 * 9 * 11 && outSize == expected &&
+         layout.size() == inSize && view.Layout::size() == inSize;
+}
+
+// Transforms each channel of interleaved real data and checks the results
+// against transforms of the separated channels.
+template <NumericConcepts::Real Real>
+auto TestInterleaved(int channels) {
+  using namespace FFTWpp;
+  using Complex = std::complex<Real>;
+  auto n = 48;
+  auto inLayout = Ranges::InterleavedLayout(channels, n);
+  auto outLayout = Ranges::InterleavedLayout(channels, n / 2 + 1);
+  auto in = Ranges::Allocate<Real>(inLayout);
+  auto out = Ranges::Allocate<Complex>(outLayout);
+  auto plan = Ranges::Plan(Ranges::View(in, inLayout),
+                           Ranges::View(out, outLayout), Estimate);
+  auto channel = vector<Real>(n);
+  auto spectrum = vector<Complex>(n / 2 + 1);
+  auto single = Ranges::Plan(Ranges::View(channel), Ranges::View(spectrum),
+                             Estimate);
+  RandomiseValues(in);
+  plan.Execute();
+  for (auto c = 0; c < channels; c++) {
+    for (auto i = 0; i < n; i++) channel[i] = in[i * channels + c];
+    single.Execute();
+    for (auto i = 0; i < n / 2 + 1; i++) {
+      if (std::abs(out[i * channels + c] - spectrum[i]) >
+          1000 * std::numeric_limits<Real>::epsilon()) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// Transforms column-major data and checks the results against the
+// row-major transform of the transposed data.
+template <NumericConcepts::Real Real>
+auto TestColumnMajor() {
+  using namespace FFTWpp;
+  using Complex = std::complex<Real>;
+  auto n0 = 6;
+  auto n1 = 10;
+  auto layout = Ranges::ColumnMajorLayout(n0, n1);
+  auto in = Ranges::Allocate<Complex>(layout);
+  auto out = Ranges::Allocate<Complex>(layout);
+  auto rowIn = vector<Complex>(n0 * n1);
+  auto rowOut = vector<Complex>(n0 * n1);
+  auto plan = Ranges::Plan(Ranges::View(in, layout), Ranges::View(out, layout),
+                           Estimate, Forward);
+  auto rowPlan = Ranges::Plan(Ranges::View(rowIn, n0, n1),
+                              Ranges::View(rowOut, n0, n1), Estimate, Forward);
+  RandomiseValues(in);
+  for (auto i = 0; i < n0; i++) {
+    for (auto j = 0; j < n1; j++) rowIn[i * n1 + j] = in[i + j * n0];
+  }
+  plan.Execute();
+  rowPlan.Execute();
+  for (auto i = 0; i < n0; i++) {
+    for (auto j = 0; j < n1; j++) {
+      if (std::abs(out[i + j * n0] - rowOut[i * n1 + j]) >
+          1000 * std::numeric_limits<Real>::epsilon()) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// Transforms a block within a larger array in-place and checks the results
+// against a transform of a copy of the block, and that the rest of the
+// array is unchanged.
+template <NumericConcepts::Real Real>
+auto TestSubBlock() {
+  using namespace FFTWpp;
+  using Complex = std::complex<Real>;
+  auto parent = std::vector{10, 12};
+  auto block = std::vector{4, 5};
+  auto layout = Ranges::SubBlockLayout(block, parent);
+  auto offset = Ranges::SubBlockOffset({3, 2}, parent);
+  auto data = vector<Complex>(parent[0] * parent[1]);
+  RandomiseValues(data);
+  auto original = data;
+  auto view = std::span(data).subspan(offset);
+  auto plan = Ranges::Plan(Ranges::View(view, layout),
+                           Ranges::View(view, layout), Estimate, Forward);
+  auto in = vector<Complex>(block[0] * block[1]);
+  auto out = vector<Complex>(block[0] * block[1]);
+  auto blockPlan = Ranges::Plan(Ranges::View(in, block[0], block[1]),
+                                Ranges::View(out, block[0], block[1]),
+                                Estimate, Forward);
+  for (auto i = 0; i < block[0]; i++) {
+    for (auto j = 0; j < block[1]; j++) {
+      in[i * block[1] + j] = original[offset + i * parent[1] + j];
+    }
+  }
+  plan.Execute();
+  blockPlan.Execute();
+  for (auto i = 0; i < parent[0]; i++) {
+    for (auto j = 0; j < parent[1]; j++) {
+      auto k = i * parent[1] + j;
+      auto inBlock = i >= 3 && i < 3 + block[0] && j >= 2 && j < 2 + block[1];
+      auto expected =
+          inBlock ? out[(i - 3) * block[1] + j - 2] : original[k];
+      if (std::abs(data[k] - expected) >
+          1000 * std::numeric_limits<Real>::epsilon()) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+#endif
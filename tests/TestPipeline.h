@@ -0,0 +1,113 @@
+#ifndef FFTWPP_TESTPIPELINE_GUARD_H
+#define FFTWPP_TESTPIPELINE_GUARD_H
+
+#include <FFTWpp/Ranges>
+#include <complex>
+#include <span>
+#include <vector>
+
+// Checks that a chain of C2C transforms and a pointwise scaling is done
+// in-place within a single buffer and returns the input.
+template <NumericConcepts::Real Real>
+auto TestPipelineInPlace() {
+  using namespace FFTWpp;
+  using Complex = std::complex<Real>;
+  auto layout = Ranges::Layout(16, 12);
+  auto pipeline = Ranges::Pipeline<Real>(Estimate);
+  auto in = pipeline.template Input<Complex>(layout);
+  auto forward =
+      pipeline.template Transform<Complex, Complex>(in, layout, Forward);
+  auto scaled = pipeline.template Pointwise<Complex>(
+      forward, [n = layout.size()](std::span<Complex> values) {
+        for (auto& value : values) value /= static_cast<Real>(n);
+      });
+  auto out =
+      pipeline.template Transform<Complex, Complex>(scaled, layout, Backward);
+  pipeline.Output(out);
+  pipeline.Build();
+  if (pipeline.Buffers() != 1 || !pipeline.InPlace(out)) return false;
+  if (4 * pipeline.Bytes() != pipeline.SeparateBytes()) return false;
+
+  auto data = pipeline.template Data<Complex>(in);
+  RandomiseValues(data);
+  auto copy = std::vector(data.begin(), data.end());
+  pipeline.Execute();
+  return CheckValues(pipeline.template Data<Complex>(out), std::span(copy),
+                     static_cast<Real>(1));
+}
+
+// Checks a circular convolution by R2C transforms of a signal and filter,
+// a pointwise product and a C2R transform. Buffers freed by the inputs are
+// reused for the later values.
+template <NumericConcepts::Real Real>
+auto TestPipelineConvolution() {
+  using namespace FFTWpp;
+  using Complex = std::complex<Real>;
+  auto n = 32;
+  auto realLayout = Ranges::Layout(n);
+  auto complexLayout = Ranges::Layout(n / 2 + 1);
+  auto pipeline = Ranges::Pipeline<Real>(Estimate);
+  auto signal = pipeline.template Input<Real>(realLayout);
+  auto filter = pipeline.template Input<Real>(realLayout);
+  auto signalSpectrum =
+      pipeline.template Transform<Complex, Real>(signal, complexLayout);
+  auto filterSpectrum =
+      pipeline.template Transform<Complex, Real>(filter, complexLayout);
+  auto product = pipeline.template Pointwise<Complex, Complex>(
+      signalSpectrum, filterSpectrum,
+      [n](std::span<Complex> values, std::span<const Complex> others) {
+        for (auto i = std::size_t{0}; i < values.size(); i++) {
+          values[i] *= others[i] / static_cast<Real>(n);
+        }
+      });
+  auto out = pipeline.template Transform<Real, Complex>(product, realLayout);
+  pipeline.Output(out);
+  pipeline.Build();
+  if (pipeline.Buffers() != 3 || !pipeline.InPlace(product)) return false;
+  if (pipeline.Buffer(out) == pipeline.Buffer(product)) return false;
+
+  auto x = pipeline.template Data<Real>(signal);
+  auto h = pipeline.template Data<Real>(filter);
+  RandomiseValues(x);
+  RandomiseValues(h);
+  auto expected = std::vector<Real>(n);
+  for (auto i = 0; i < n; i++) {
+    for (auto j = 0; j < n; j++) expected[i] += x[j] * h[(i - j + n) % n];
+  }
+  pipeline.Execute();
+  return CheckValues(pipeline.template Data<Real>(out), std::span(expected),
+                     static_cast<Real>(1));
+}
+
+// Checks that a two-dimensional C2R transform whose input is kept as an
+// output leaves that input unchanged, by comparing the output with an
+// inverse transform of the kept spectrum.
+template <NumericConcepts::Real Real>
+auto TestPipelinePreserved() {
+  using namespace FFTWpp;
+  using Complex = std::complex<Real>;
+  auto realLayout = Ranges::Layout(8, 12);
+  auto complexLayout = Ranges::Layout(8, 12 / 2 + 1);
+  auto pipeline = Ranges::Pipeline<Real>(Estimate);
+  auto in = pipeline.template Input<Real>(realLayout);
+  auto spectrum =
+      pipeline.template Transform<Complex, Real>(in, complexLayout);
+  auto out = pipeline.template Transform<Real, Complex>(spectrum, realLayout);
+  pipeline.Output(spectrum);
+  pipeline.Output(out);
+  pipeline.Build();
+
+  auto data = pipeline.template Data<Real>(in);
+  RandomiseValues(data);
+  pipeline.Execute();
+  auto kept = pipeline.template Data<Complex>(spectrum);
+  auto copy = vector<Complex>(kept.begin(), kept.end());
+  auto expected = vector<Real>(realLayout.size());
+  auto inverse = Ranges::Plan(Ranges::View(copy, complexLayout),
+                              Ranges::View(expected, realLayout), Estimate);
+  inverse.Execute();
+  return CheckValues(pipeline.template Data<Real>(out), std::span(expected),
+                     static_cast<Real>(1));
+}
+
+#endif  // FFTWPP_TESTPIPELINE_GUARD_H
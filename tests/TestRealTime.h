@@ -0,0 +1,92 @@
+#ifndef FFTWPP_TESTREALTIME_GUARD_H
+#define FFTWPP_TESTREALTIME_GUARD_H
+
+#include <FFTWpp/Ranges>
+#include <complex>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "RealTimeHooks.h"
+
+// Checks that, once warmed up, executes of a plan make no allocations,
+// locks or system calls. The plan is executed directly, with new arrays of
+// the same and of different alignment, and on a batch of array pairs. The
+// plan for unaligned arrays is made beforehand.
+template <NumericConcepts::RealOrComplex InType,
+          NumericConcepts::RealOrComplex OutType, typename... Args>
+auto TestRealTimeExecute(Args... args) {
+  using namespace FFTWpp;
+  auto n = std::vector{6, 8};
+  auto [inSize, outSize] = DataSize<InType, OutType>(n[0], n[1]);
+  auto inN = n;
+  auto outN = n;
+  if constexpr (NumericConcepts::Complex<InType> &&
+                NumericConcepts::Real<OutType>) {
+    inN.back() = n.back() / 2 + 1;
+  }
+  if constexpr (NumericConcepts::Real<InType> &&
+                NumericConcepts::Complex<OutType>) {
+    outN.back() = n.back() / 2 + 1;
+  }
+  auto inLayout = Ranges::Layout(2, inN, 1, inN, 1, 0);
+  auto outLayout = Ranges::Layout(2, outN, 1, outN, 1, 0);
+  auto in = vector<InType>(inSize);
+  auto out = vector<OutType>(outSize);
+  auto other = vector<InType>(inSize + 1);
+  auto otherOut = vector<OutType>(outSize);
+  auto plan = Ranges::Plan(Ranges::View(in, inLayout),
+                           Ranges::View(out, outLayout), Measure, args...);
+  plan.PrepareUnaligned();
+  RandomiseValues(in);
+  RandomiseValues(other);
+  auto aligned = std::span(other.data(), inSize);
+  auto shifted = std::span(other.data() + 1, inSize);
+  auto pairs = std::vector<std::pair<InType*, OutType*>>{
+      {in.data(), out.data()}, {other.data(), otherOut.data()}};
+
+  auto execute = [&]() {
+    plan.Execute();
+    plan.Execute(aligned, std::span(otherOut));
+    plan.Execute(shifted, std::span(otherOut));
+    plan.Execute(std::span<const std::pair<InType*, OutType*>>(pairs));
+  };
+  execute();
+  auto region = RealTimeRegion();
+  execute();
+  return region.Violations().None();
+}
+
+// Checks that iterating through the transforms of a range of frames makes
+// no allocations, locks or system calls once iteration has begun.
+template <NumericConcepts::Real Real>
+auto TestRealTimeStreaming() {
+  using namespace FFTWpp;
+  auto frames = std::vector<std::vector<Real>>(20, std::vector<Real>(16));
+  for (auto& frame : frames) RandomiseValues(frame);
+  auto spectra = frames | views::rfft(8, Estimate);
+  auto it = spectra.begin();
+  auto total = Real{0};
+  auto region = RealTimeRegion();
+  for (; it != spectra.end(); ++it) total += std::abs((*it)[0]);
+  return region.Violations().None() && total > 0;
+}
+
+// Checks that executing a fixed-size plan makes no allocations, locks or
+// system calls.
+template <NumericConcepts::Real Real>
+auto TestRealTimeFixed() {
+  using namespace FFTWpp;
+  using Complex = std::complex<Real>;
+  auto in = vector<Complex>(8);
+  auto out = vector<Complex>(8);
+  auto plan = Ranges::MakeFixedPlan<8>(Ranges::View(in), Ranges::View(out),
+                                       Estimate, Forward);
+  RandomiseValues(in);
+  auto region = RealTimeRegion();
+  plan.Execute();
+  plan.Execute(std::span(in), std::span(out));
+  return region.Violations().None();
+}
+
+#endif
@@ -1,6 +1,14 @@
 #include <gtest/gtest.h>
 
 #include "Test1D.h"
+#include "TestAdaptors.h"
+#include "TestCache.h"
+#include "TestExecute.h"
+#include "TestFixed.h"
+#include "TestInstrumentation.h"
+#include "TestLayouts.h"
+#include "TestPipeline.h"
+#include "TestRealTime.h"
 
 // 1D C2C tests
 TEST(Test1DC2C, FLOAT) {
@@ -61,3 +69,424 @@ TEST(Test1DR2R, LONGDOUBLE) {
   auto result = Test1D<Real, Real>();
   EXPECT_TRUE(result);
 }
+
+// Fixed-size kernel tests
+TEST(TestFixedC2C, FLOAT) {
+  using Complex = std::complex<float>;
+  auto result = TestFixed<Complex, Complex, 16>();
+  EXPECT_TRUE(result);
+}
+
+TEST(TestFixedC2C, DOUBLE) {
+  using Complex = std::complex<double>;
+  auto result = TestFixed<Complex, Complex, 7>();
+  EXPECT_TRUE(result);
+}
+
+TEST(TestFixedR2C, DOUBLE) {
+  using Real = double;
+  using Complex = std::complex<Real>;
+  auto result = TestFixed<Real, Complex, 32>();
+  EXPECT_TRUE(result);
+}
+
+TEST(TestFixedC2R, DOUBLE) {
+  using Real = double;
+  using Complex = std::complex<Real>;
+  auto result = TestFixed<Complex, Real, 9>();
+  EXPECT_TRUE(result);
+}
+
+TEST(TestFixedC2R, FLOAT) {
+  using Real = float;
+  using Complex = std::complex<Real>;
+  auto result =
+      TestFixed<Complex, Real, 16>() && TestFixed<Complex, Real, 12>();
+  EXPECT_TRUE(result);
+}
+
+TEST(TestFixedR2R, DOUBLE) {
+  using Real = double;
+  for (auto kind : {FFTWpp::R2HC, FFTWpp::HC2R, FFTWpp::DHT, FFTWpp::REDFT00,
+                    FFTWpp::REDFT10, FFTWpp::REDFT01, FFTWpp::REDFT11,
+                    FFTWpp::RODFT00, FFTWpp::RODFT10, FFTWpp::RODFT01,
+                    FFTWpp::RODFT11}) {
+    auto result = TestFixed<Real, Real, 8, 8>(kind);
+    EXPECT_TRUE(result);
+  }
+}
+
+TEST(TestFixedFallback, DOUBLE) {
+  using Real = double;
+  using Complex = std::complex<Real>;
+  auto result = TestFixed<Complex, Complex, 128>();
+  EXPECT_TRUE(result);
+}
+
+// Execute on batches of buffer pairs
+TEST(TestExecutePairs, SERIAL) {
+  auto result = TestExecutePairs<double>(false);
+  EXPECT_TRUE(result);
+}
+
+TEST(TestExecutePairs, PARALLEL) {
+  auto result = TestExecutePairs<float>(true);
+  EXPECT_TRUE(result);
+}
+
+TEST(TestUnaligned, FLOAT) {
+  auto result = TestUnaligned<float>();
+  EXPECT_TRUE(result);
+}
+
+TEST(TestUnaligned, DOUBLE) {
+  auto result = TestUnaligned<double>();
+  EXPECT_TRUE(result);
+}
+
+// Range adaptor tests
+TEST(TestPowerSpectra, FLOAT) {
+  auto result = TestPowerSpectra<float>(16);
+  EXPECT_TRUE(result);
+}
+
+TEST(TestPowerSpectra, DOUBLE) {
+  auto result = TestPowerSpectra<double>(7);
+  EXPECT_TRUE(result);
+}
+
+TEST(TestFrameReads, DOUBLE) {
+  auto result = TestFrameReads<double>(4);
+  EXPECT_TRUE(result);
+}
+
+TEST(TestConvolve, DOUBLE) {
+  auto result = TestConvolve<double>();
+  EXPECT_TRUE(result);
+}
+
+// Auto-tuner tests
+TEST(TestTuner, FEW) {
+  auto result = TestTuner<double>(1);
+  EXPECT_TRUE(result);
+}
+
+TEST(TestTuner, MANY) {
+  auto result = TestTuner<float>(1000000);
+  EXPECT_TRUE(result);
+}
+
+TEST(TestTuner, ODD) {
+  auto result = TestTuner<float>(1000000, 3, 2);
+  EXPECT_TRUE(result);
+}
+
+TEST(TestPlanningAdvisor, DOUBLE) {
+  auto result = TestPlanningAdvisor<double>();
+  EXPECT_TRUE(result);
+}
+
+TEST(TestAdaptivePlan, DOUBLE) {
+  auto result = TestAdaptivePlan<double>();
+  EXPECT_TRUE(result);
+}
+
+#if defined(__linux__)
+TEST(TestService, DOUBLE) {
+  auto result = TestService<double>();
+  EXPECT_TRUE(result);
+}
+#endif
+
+// Layout advisor tests
+TEST(TestReorder, ONE) {
+  auto result = TestReorder<double>({37});
+  EXPECT_TRUE(result);
+}
+
+TEST(TestReorder, THREE) {
+  auto result = TestReorder<std::complex<float>>({5, 6, 7});
+  EXPECT_TRUE(result);
+}
+
+TEST(TestAdviseLayout, C2C) {
+  using Complex = std::complex<double>;
+  auto result =
+      TestAdviseLayout<Complex, Complex>({16, 16}, 8, FFTWpp::Forward);
+  EXPECT_TRUE(result);
+}
+
+TEST(TestAdviseLayout, R2C) {
+  using Real = float;
+  using Complex = std::complex<Real>;
+  auto result = TestAdviseLayout<Real, Complex>({32}, 20);
+  EXPECT_TRUE(result);
+}
+
+TEST(TestAdviseLayout, R2R) {
+  auto result = TestAdviseLayout<double, double>({8, 12}, 4,
+                                                FFTWpp::REDFT10);
+  EXPECT_TRUE(result);
+}
+
+// Padded embed tests
+TEST(TestPadded, C2C) {
+  using Complex = std::complex<double>;
+  auto result = TestPadded<Complex, Complex>({32, 64}, FFTWpp::Forward);
+  EXPECT_TRUE(result);
+}
+
+TEST(TestPadded, R2C) {
+  using Real = float;
+  using Complex = std::complex<Real>;
+  auto result = TestPadded<Real, Complex>({8, 16, 32});
+  EXPECT_TRUE(result);
+}
+
+TEST(TestPadded, C2R) {
+  using Real = double;
+  using Complex = std::complex<Real>;
+  auto result = TestPadded<Complex, Real>({16, 16});
+  EXPECT_TRUE(result);
+}
+
+TEST(TestPaddedSize, R2C) {
+  using Real = double;
+  using Complex = std::complex<Real>;
+  auto result = TestPaddedSize<Real, Complex>();
+  EXPECT_TRUE(result);
+}
+
+// Named layout tests
+TEST(TestInterleaved, FLOAT) {
+  auto result = TestInterleaved<float>(2);
+  EXPECT_TRUE(result);
+}
+
+TEST(TestInterleaved, DOUBLE) {
+  auto result = TestInterleaved<double>(5);
+  EXPECT_TRUE(result);
+}
+
+TEST(TestColumnMajor, DOUBLE) {
+  auto result = TestColumnMajor<double>();
+  EXPECT_TRUE(result);
+}
+
+TEST(TestSubBlock, DOUBLE) {
+  auto result = TestSubBlock<double>();
+  EXPECT_TRUE(result);
+}
+
+// Subnormal handling tests
+TEST(TestFlushDenormals, FLOAT) {
+  auto result = TestFlushDenormals<float>();
+  EXPECT_TRUE(result);
+}
+
+TEST(TestFlushDenormals, DOUBLE) {
+  auto result = TestFlushDenormals<double>();
+  EXPECT_TRUE(result);
+}
+
+TEST(TestSubnormalSampling, FLOAT) {
+  auto result = TestSubnormalSampling<float>();
+  EXPECT_TRUE(result);
+}
+
+TEST(TestSubnormalSampling, DOUBLE) {
+  auto result = TestSubnormalSampling<double>();
+  EXPECT_TRUE(result);
+}
+
+// Real-time preparation tests
+TEST(TestPrepareRealTime, DOUBLE) {
+  auto result = TestPrepareRealTime<double>();
+  EXPECT_TRUE(result);
+}
+
+// Real-time safety tests
+TEST(TestRealTimeC2C, FLOAT) {
+  using Complex = std::complex<float>;
+  auto result = TestRealTimeExecute<Complex, Complex>(FFTWpp::Forward);
+  EXPECT_TRUE(result);
+}
+
+TEST(TestRealTimeR2C, FLOAT) {
+  using Real = float;
+  using Complex = std::complex<Real>;
+  auto result = TestRealTimeExecute<Real, Complex>();
+  EXPECT_TRUE(result);
+}
+
+TEST(TestRealTimeC2R, FLOAT) {
+  using Real = float;
+  using Complex = std::complex<Real>;
+  auto result = TestRealTimeExecute<Complex, Real>();
+  EXPECT_TRUE(result);
+}
+
+TEST(TestRealTimeR2R, FLOAT) {
+  using Real = float;
+  auto result = TestRealTimeExecute<Real, Real>(FFTWpp::REDFT10);
+  EXPECT_TRUE(result);
+}
+
+TEST(TestRealTimeC2C, DOUBLE) {
+  using Complex = std::complex<double>;
+  auto result = TestRealTimeExecute<Complex, Complex>(FFTWpp::Forward);
+  EXPECT_TRUE(result);
+}
+
+TEST(TestRealTimeR2C, DOUBLE) {
+  using Real = double;
+  using Complex = std::complex<Real>;
+  auto result = TestRealTimeExecute<Real, Complex>();
+  EXPECT_TRUE(result);
+}
+
+TEST(TestRealTimeC2R, DOUBLE) {
+  using Real = double;
+  using Complex = std::complex<Real>;
+  auto result = TestRealTimeExecute<Complex, Real>();
+  EXPECT_TRUE(result);
+}
+
+TEST(TestRealTimeR2R, DOUBLE) {
+  using Real = double;
+  auto result = TestRealTimeExecute<Real, Real>(FFTWpp::REDFT10);
+  EXPECT_TRUE(result);
+}
+
+TEST(TestRealTimeC2C, LONGDOUBLE) {
+  using Complex = std::complex<long double>;
+  auto result = TestRealTimeExecute<Complex, Complex>(FFTWpp::Forward);
+  EXPECT_TRUE(result);
+}
+
+TEST(TestRealTimeR2C, LONGDOUBLE) {
+  using Real = long double;
+  using Complex = std::complex<Real>;
+  auto result = TestRealTimeExecute<Real, Complex>();
+  EXPECT_TRUE(result);
+}
+
+TEST(TestRealTimeC2R, LONGDOUBLE) {
+  using Real = long double;
+  using Complex = std::complex<Real>;
+  auto result = TestRealTimeExecute<Complex, Real>();
+  EXPECT_TRUE(result);
+}
+
+TEST(TestRealTimeR2R, LONGDOUBLE) {
+  using Real = long double;
+  auto result = TestRealTimeExecute<Real, Real>(FFTWpp::REDFT10);
+  EXPECT_TRUE(result);
+}
+
+TEST(TestRealTimeStreaming, DOUBLE) {
+  auto result = TestRealTimeStreaming<double>();
+  EXPECT_TRUE(result);
+}
+
+TEST(TestRealTimeFixed, FLOAT) {
+  auto result = TestRealTimeFixed<float>();
+  EXPECT_TRUE(result);
+}
+
+// Plan cache and warm-up tests
+TEST(TestGenerateWisdom, FLOAT) {
+  auto result = TestGenerateWisdom<float>();
+  EXPECT_TRUE(result);
+}
+
+TEST(TestGenerateWisdom, DOUBLE) {
+  auto result = TestGenerateWisdom<double>();
+  EXPECT_TRUE(result);
+}
+
+TEST(TestWarmUp, MANIFEST) {
+  auto result = TestWarmUp();
+  EXPECT_TRUE(result);
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+TEST(TestForkPreparation, DOUBLE) {
+  auto result = TestForkPreparation();
+  EXPECT_TRUE(result);
+}
+#endif
+
+// Memory accounting tests
+TEST(TestMemoryAccounting, DOUBLE) {
+  auto result = TestMemoryAccounting();
+  EXPECT_TRUE(result);
+}
+
+TEST(TestCacheBudget, DOUBLE) {
+  auto result = TestCacheBudget();
+  EXPECT_TRUE(result);
+}
+
+// Pipeline tests
+TEST(TestPipelineInPlace, FLOAT) {
+  auto result = TestPipelineInPlace<float>();
+  EXPECT_TRUE(result);
+}
+
+TEST(TestPipelineInPlace, DOUBLE) {
+  auto result = TestPipelineInPlace<double>();
+  EXPECT_TRUE(result);
+}
+
+TEST(TestPipelineConvolution, DOUBLE) {
+  auto result = TestPipelineConvolution<double>();
+  EXPECT_TRUE(result);
+}
+
+TEST(TestPipelinePreserved, DOUBLE) {
+  auto result = TestPipelinePreserved<double>();
+  EXPECT_TRUE(result);
+}
+
+// Input ownership tests
+TEST(TestInputOwnership, FLOAT) {
+  auto result = TestInputOwnership<float>();
+  EXPECT_TRUE(result);
+}
+
+TEST(TestInputOwnership, DOUBLE) {
+  auto result = TestInputOwnership<double>();
+  EXPECT_TRUE(result);
+}
+
+TEST(TestRelativeError, FLOAT) {
+  auto result = TestRelativeError<float>();
+  EXPECT_TRUE(result);
+}
+
+TEST(TestRelativeError, DOUBLE) {
+  auto result = TestRelativeError<double>();
+  EXPECT_TRUE(result);
+}
+
+// Instrumentation tests
+TEST(TestCounterProfiler, DOUBLE) {
+  auto result = TestCounterProfiler<double>();
+  EXPECT_TRUE(result);
+}
+
+TEST(TestTracer, DOUBLE) {
+  auto result = TestTracer<double>();
+  EXPECT_TRUE(result);
+}
+
+TEST(TestFlops, FLOAT) {
+  auto result = TestFlops<float>();
+  EXPECT_TRUE(result);
+}
+
+TEST(TestFlops, DOUBLE) {
+  auto result = TestFlops<double>();
+  EXPECT_TRUE(result);
+}